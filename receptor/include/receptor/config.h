@@ -129,6 +129,7 @@
 #define RECEPTOR_DEFAULT_PORT        8080
 #define RECEPTOR_DEFAULT_BACKLOG     511
 #define RECEPTOR_DEFAULT_WORKERS     1
+#define RECEPTOR_DEFAULT_CONNECTIONS 1024
 #define RECEPTOR_DEFAULT_TIMEOUT     30000
 #define RECEPTOR_MAX_HEADER_SIZE     8192
 #define RECEPTOR_MAX_BODY_SIZE       10485760  /* 10MB */
@@ -8,6 +8,8 @@
 #ifdef _WIN32
 #include <winsock2.h>
 #include <windows.h>
+#else
+#include <sys/types.h>
 #endif
 
 /* 包含自动生成的配置头文件 */
@@ -52,6 +54,15 @@ typedef int                 receptor_socket_t;
 #define RECEPTOR_API
 #endif
 
+/* 缓存行对齐，用于按缓存行布局的热点结构 */
+#define RECEPTOR_CACHELINE_SIZE 64
+
+#if defined(_MSC_VER)
+#define RECEPTOR_CACHELINE_ALIGNED __declspec(align(RECEPTOR_CACHELINE_SIZE))
+#else
+#define RECEPTOR_CACHELINE_ALIGNED __attribute__((aligned(RECEPTOR_CACHELINE_SIZE)))
+#endif
+
 /* 时间类型 */
 #ifdef _WIN32
 typedef LARGE_INTEGER       receptor_time_t;
@@ -3,7 +3,10 @@
 #include "receptor_array.h"
 #include "receptor_list.h"
 #include "receptor_palloc.h"
+#include "receptor_shm_slab.h"
 #include "receptor_string.h"
+#include <receptor_event.h>
+#include <receptor_event_connection.h>
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -37,6 +40,7 @@ struct receptor_core_conf_s {
 	receptor_uint_t         daemon;
 	receptor_uint_t         master;
 	receptor_uint_t         worker_processes;
+	receptor_uint_t         worker_connections;
 	receptor_uint_t         debug_points;
 };
 
@@ -50,6 +54,8 @@ struct receptor_cycle_s {
 	void*                   event_ctx;
 	void*                   http_ctx;
 	void*                   stream_ctx;
+	receptor_pool_t*        shm_pool;       /* shared_memory 及其中的区，重新加载时整个替换 */
+	receptor_array_t*       shared_memory;  /* receptor_shm_zone_t * */
 };
 
 /* ==================== 全局变量 ==================== */
@@ -60,6 +66,9 @@ static receptor_array_t*    receptor_modules = NULL;
 static char                 receptor_error_buf[RECEPTOR_MAX_ERROR_STR];
 static receptor_int_t       receptor_last_error = 0;
 
+/* 控制信号作用的周期，在 receptor_start 中设置 */
+static receptor_cycle_t*    receptor_signal_cycle = NULL;
+
 /* 内置核心模块声明 */
 extern receptor_module_t receptor_core_module;
 extern receptor_module_t receptor_event_module;
@@ -81,6 +90,10 @@ static receptor_int_t receptor_internal_init(void);
 static void receptor_internal_cleanup(void);
 static receptor_int_t receptor_init_builtin_modules(void);
 static receptor_int_t receptor_init_global_pool(void);
+static receptor_int_t receptor_init_cycle_signals(receptor_cycle_t* cycle);
+static receptor_int_t receptor_create_zones(receptor_cycle_t* cycle, receptor_uint_t n);
+static receptor_int_t receptor_init_zones(receptor_cycle_t* cycle, receptor_array_t* old);
+static void receptor_free_zones(receptor_array_t* zones, receptor_array_t* keep);
 
 /* ==================== 内置模块定义 ==================== */
 
@@ -105,13 +118,13 @@ receptor_module_t receptor_core_module = {
 };
 
 /* 事件模块 */
-static receptor_int_t receptor_event_init(receptor_cycle_t* cycle) {
+static receptor_int_t receptor_event_init_module(receptor_cycle_t* cycle) {
 	(void)cycle;  // 避免未使用参数警告
 	printf("Event module initialized\n");
 	return RECEPTOR_OK;
 }
 
-static receptor_int_t receptor_event_exit(receptor_cycle_t* cycle) {
+static receptor_int_t receptor_event_exit_module(receptor_cycle_t* cycle) {
 	(void)cycle;  // 避免未使用参数警告
 	printf("Event module exited\n");
 	return RECEPTOR_OK;
@@ -120,8 +133,8 @@ static receptor_int_t receptor_event_exit(receptor_cycle_t* cycle) {
 receptor_module_t receptor_event_module = {
 	"event",
 	NULL,
-	receptor_event_init,
-	receptor_event_exit
+	receptor_event_init_module,
+	receptor_event_exit_module
 };
 
 /* HTTP模块 */
@@ -368,6 +381,9 @@ receptor_init_cycle(receptor_conf_ctx_t* conf_ctx)
 		return NULL;
 	}
 
+	/* 模块配置多时周期池会持续增长，块按倍数放大以减少块数 */
+	receptor_pool_set_growth(pool, 64 * 1024);
+
 	cycle = receptor_pcalloc(pool, sizeof(receptor_cycle_t));
 	if (cycle == NULL) {
 		receptor_destroy_pool(pool);
@@ -391,10 +407,16 @@ receptor_init_cycle(receptor_conf_ctx_t* conf_ctx)
 
 	/* 设置默认值 */
 	cycle->conf->worker_processes = 1;
+	cycle->conf->worker_connections = RECEPTOR_DEFAULT_CONNECTIONS;
 	cycle->conf->daemon = 0;
 	cycle->conf->master = 0;
 	cycle->conf->debug_points = 0;
 
+	if (receptor_create_zones(cycle, 4) != RECEPTOR_OK) {
+		receptor_destroy_pool(pool);
+		return NULL;
+	}
+
 	return cycle;
 }
 
@@ -402,6 +424,8 @@ RECEPTOR_API void
 receptor_destroy_cycle(receptor_cycle_t* cycle)
 {
 	if (cycle && cycle->pool) {
+		receptor_free_zones(cycle->shared_memory, NULL);
+		receptor_destroy_pool(cycle->shm_pool);
 		receptor_destroy_pool(cycle->pool);
 	}
 }
@@ -417,6 +441,71 @@ receptor_get_core_conf(receptor_cycle_t* cycle)
 	return cycle->conf;
 }
 
+RECEPTOR_API receptor_shm_zone_t*
+receptor_shared_memory_add(receptor_cycle_t* cycle, const char* name, size_t size, void* tag)
+{
+	size_t len;
+	receptor_uint_t i;
+	receptor_shm_zone_t* zone;
+	receptor_shm_zone_t** zones;
+
+	if (!cycle || !name) {
+		receptor_set_error("Invalid arguments");
+		return NULL;
+	}
+
+	len = strlen(name);
+	size = (size + RECEPTOR_SHM_PAGE_SIZE - 1) & ~((size_t)RECEPTOR_SHM_PAGE_SIZE - 1);
+
+	if (size < RECEPTOR_SHM_MIN_PAGES * RECEPTOR_SHM_PAGE_SIZE) {
+		size = RECEPTOR_SHM_MIN_PAGES * RECEPTOR_SHM_PAGE_SIZE;
+	}
+
+	zones = (receptor_shm_zone_t**)cycle->shared_memory->elts;
+
+	for (i = 0; i < cycle->shared_memory->nelts; i++) {
+		zone = zones[i];
+
+		if (zone->shm.name.len != len || memcmp(zone->shm.name.data, name, len) != 0) {
+			continue;
+		}
+
+		if (zone->tag != tag || zone->shm.size != size) {
+			receptor_set_error("Shared memory zone \"%s\" is already declared differently", name);
+			return NULL;
+		}
+
+		return zone;
+	}
+
+	zone = receptor_pcalloc(cycle->shm_pool, sizeof(receptor_shm_zone_t));
+	if (zone == NULL) {
+		receptor_set_error("Failed to allocate shared memory zone");
+		return NULL;
+	}
+
+	zone->shm.name.data = receptor_pnalloc(cycle->shm_pool, len + 1);
+	if (zone->shm.name.data == NULL) {
+		receptor_set_error("Failed to allocate shared memory zone");
+		return NULL;
+	}
+
+	memcpy(zone->shm.name.data, name, len + 1);
+	zone->shm.name.len = len;
+	zone->shm.size = size;
+	zone->tag = tag;
+
+	zones = receptor_array_push(cycle->shared_memory);
+	if (zones == NULL) {
+		receptor_set_error("Failed to allocate shared memory zone");
+		return NULL;
+	}
+
+	*zones = zone;
+
+	return zone;
+}
+
 /* ==================== 模块管理实现 ==================== */
 
 RECEPTOR_API receptor_int_t
@@ -543,10 +632,30 @@ receptor_start(receptor_cycle_t* cycle)
 		return RECEPTOR_ERROR;
 	}
 
+	/* 模块登记的共享内存区在派生工作进程之前创建 */
+	if (receptor_init_zones(cycle, NULL) != RECEPTOR_OK) {
+		receptor_free_zones(cycle->shared_memory, NULL);
+		return RECEPTOR_ERROR;
+	}
+
+	/* 默认循环的连接表按 worker_connections 一次性分配 */
+	if (receptor_event_default_loop() != NULL
+		&& receptor_event_default_loop()->connections == NULL
+		&& receptor_event_loop_init_connections(receptor_event_default_loop(),
+			cycle->conf->worker_connections) != RECEPTOR_OK)
+	{
+		receptor_set_error("Failed to allocate %lu connections", (unsigned long)cycle->conf->worker_connections);
+		return RECEPTOR_ERROR;
+	}
+
 	cycle->running = 1;
 	cycle->terminate = 0;
 	cycle->quit = 0;
 
+	if (receptor_init_cycle_signals(cycle) != RECEPTOR_OK) {
+		return RECEPTOR_ERROR;
+	}
+
 	printf("Receptor started successfully\n");
 	return RECEPTOR_OK;
 }
@@ -567,6 +676,10 @@ receptor_stop(receptor_cycle_t* cycle)
 	cycle->running = 0;
 	cycle->terminate = 1;
 
+	if (receptor_signal_cycle == cycle) {
+		receptor_signal_cycle = NULL;
+	}
+
 	/* 退出所有模块 */
 	receptor_exit_modules(cycle);
 
@@ -577,6 +690,9 @@ receptor_stop(receptor_cycle_t* cycle)
 RECEPTOR_API receptor_int_t
 receptor_reload(receptor_cycle_t* cycle)
 {
+	receptor_pool_t* old_pool;
+	receptor_array_t* old;
+
 	if (!cycle) {
 		receptor_set_error("Invalid cycle");
 		return RECEPTOR_ERROR;
@@ -584,9 +700,53 @@ receptor_reload(receptor_cycle_t* cycle)
 
 	printf("Reloading configuration...\n");
 
-	/* 这里实现配置重载逻辑 */
+	/*
+	 * 模块在新的区列表中重新登记共享内存区，与旧的逐一比对。
+	 * 区列表放在自己的池中，成功后旧池整个释放，反复重新加载不会占用周期池。
+	 */
+	old_pool = cycle->shm_pool;
+	old = cycle->shared_memory;
 
-	return RECEPTOR_OK;
+	if (receptor_create_zones(cycle, old->nelts ? old->nelts : 4) != RECEPTOR_OK) {
+		return RECEPTOR_ERROR;
+	}
+
+	receptor_exit_modules(cycle);
+
+	if (receptor_init_modules(cycle) == RECEPTOR_OK
+		&& receptor_init_zones(cycle, old) == RECEPTOR_OK)
+	{
+		receptor_free_zones(old, cycle->shared_memory);
+		receptor_destroy_pool(old_pool);
+		return RECEPTOR_OK;
+	}
+
+	/* 模块可能只初始化了一部分：全部退出，丢弃新建的映射，按原有的区重新初始化 */
+	receptor_exit_modules(cycle);
+	receptor_free_zones(cycle->shared_memory, old);
+	receptor_destroy_pool(cycle->shm_pool);
+
+	cycle->shm_pool = old_pool;
+	cycle->shared_memory = old;
+
+	if (receptor_init_modules(cycle) != RECEPTOR_OK
+		|| receptor_init_zones(cycle, old) != RECEPTOR_OK)
+	{
+		/* 无法恢复，模块保持退出状态，周期停止运行 */
+		receptor_exit_modules(cycle);
+		cycle->running = 0;
+		cycle->terminate = 1;
+
+		if (receptor_signal_cycle == cycle) {
+			receptor_signal_cycle = NULL;
+		}
+
+		receptor_set_error("Reload failed and modules could not be restored, receptor stopped");
+		return RECEPTOR_ERROR;
+	}
+
+	/* 保留第一次失败时设置的错误信息 */
+	return RECEPTOR_ERROR;
 }
 
 /* ==================== 工具函数实现 ==================== */
@@ -640,15 +800,235 @@ receptor_init_signals(void)
 #endif
 }
 
+/* 信号经默认事件循环递送，handler 在循环线程上执行，不受异步信号安全的限制 */
 RECEPTOR_API receptor_int_t
 receptor_add_signal(int signum, void(*handler)(int))
 {
-	/* 暂时不实现具体信号处理 */
-	(void)signum;
-	(void)handler;
+	receptor_event_loop_t* loop;
+
+	loop = receptor_event_default_loop();
+	if (loop == NULL) {
+		receptor_set_error("Event loop not initialized");
+		return RECEPTOR_ERROR;
+	}
+
+	if (receptor_event_loop_add_signal(loop, signum, handler) != RECEPTOR_OK) {
+		receptor_set_error("Failed to add signal: %d", signum);
+		return RECEPTOR_ERROR;
+	}
+
 	return RECEPTOR_OK;
 }
 
+#ifndef _WIN32
+
+/* SIGHUP：重新加载配置 */
+static void
+receptor_signal_reload(int signo)
+{
+	(void)signo;
+
+	if (receptor_signal_cycle) {
+		receptor_reload(receptor_signal_cycle);
+	}
+}
+
+/* SIGQUIT：优雅退出，本轮事件处理完后循环返回，由调用者收尾 */
+static void
+receptor_signal_quit(int signo)
+{
+	(void)signo;
+
+	if (receptor_signal_cycle) {
+		receptor_signal_cycle->quit = 1;
+	}
+
+	receptor_event_loop_stop(receptor_event_default_loop());
+}
+
+/* SIGTERM/SIGINT：立即停止 */
+static void
+receptor_signal_terminate(int signo)
+{
+	(void)signo;
+
+	if (receptor_signal_cycle) {
+		receptor_stop(receptor_signal_cycle);
+	}
+
+	receptor_event_loop_stop(receptor_event_default_loop());
+}
+
+#endif
+
+/* 默认事件循环存在时，把控制信号注册到循环中 */
+static receptor_int_t
+receptor_init_cycle_signals(receptor_cycle_t* cycle)
+{
+	if (receptor_event_default_loop() == NULL) {
+		return RECEPTOR_OK;
+	}
+
+	receptor_signal_cycle = cycle;
+
+#ifndef _WIN32
+	if (receptor_add_signal(SIGHUP, receptor_signal_reload) != RECEPTOR_OK
+		|| receptor_add_signal(SIGQUIT, receptor_signal_quit) != RECEPTOR_OK
+		|| receptor_add_signal(SIGTERM, receptor_signal_terminate) != RECEPTOR_OK
+		|| receptor_add_signal(SIGINT, receptor_signal_terminate) != RECEPTOR_OK)
+	{
+		return RECEPTOR_ERROR;
+	}
+#endif
+
+	return RECEPTOR_OK;
+}
+
+/* ==================== 共享内存区 ==================== */
+
+/* 新建一个区列表及其池，成功后替换 cycle 中的，原有的由调用者释放 */
+static receptor_int_t
+receptor_create_zones(receptor_cycle_t* cycle, receptor_uint_t n)
+{
+	receptor_pool_t* pool;
+	receptor_array_t* zones;
+
+	pool = receptor_create_pool(1024);
+	if (pool == NULL) {
+		receptor_set_error("Failed to create shared memory pool");
+		return RECEPTOR_ERROR;
+	}
+
+	zones = receptor_array_create(pool, n, sizeof(receptor_shm_zone_t*));
+	if (zones == NULL) {
+		receptor_destroy_pool(pool);
+		receptor_set_error("Failed to create shared memory array");
+		return RECEPTOR_ERROR;
+	}
+
+	cycle->shm_pool = pool;
+	cycle->shared_memory = zones;
+
+	return RECEPTOR_OK;
+}
+
+/* 在 old 中找名称、大小和 tag 都相同的区 */
+static receptor_shm_zone_t*
+receptor_find_zone(receptor_array_t* old, receptor_shm_zone_t* zone)
+{
+	receptor_uint_t i;
+	receptor_shm_zone_t* oz;
+	receptor_shm_zone_t** zones;
+
+	if (old == NULL || zone->noreuse) {
+		return NULL;
+	}
+
+	zones = (receptor_shm_zone_t**)old->elts;
+
+	for (i = 0; i < old->nelts; i++) {
+		oz = zones[i];
+
+		if (oz->shm.addr != NULL
+			&& oz->tag == zone->tag
+			&& oz->shm.size == zone->shm.size
+			&& oz->shm.name.len == zone->shm.name.len
+			&& memcmp(oz->shm.name.data, zone->shm.name.data, zone->shm.name.len) == 0)
+		{
+			return oz;
+		}
+	}
+
+	return NULL;
+}
+
+static receptor_int_t
+receptor_init_zones(receptor_cycle_t* cycle, receptor_array_t* old)
+{
+	receptor_uint_t i;
+	receptor_str_t name;
+	receptor_shm_zone_t* zone;
+	receptor_shm_zone_t* oz;
+	receptor_shm_zone_t** zones;
+
+	zones = (receptor_shm_zone_t**)cycle->shared_memory->elts;
+
+	for (i = 0; i < cycle->shared_memory->nelts; i++) {
+		zone = zones[i];
+
+		/* 重新加载失败后恢复原有的区时，区本身已有映射 */
+		oz = zone->shm.addr ? zone : receptor_find_zone(old, zone);
+
+		if (oz) {
+			/* 沿用映射和其中的数据，名称仍用本周期池中的副本 */
+			name = zone->shm.name;
+			zone->shm = oz->shm;
+			zone->shm.name = name;
+			zone->shm.exists = 1;
+
+			if (zone->init && zone->init(zone, oz->data) != RECEPTOR_OK) {
+				receptor_set_error("Failed to reuse shared memory zone \"%s\"", (char*)zone->shm.name.data);
+				return RECEPTOR_ERROR;
+			}
+
+			continue;
+		}
+
+		if (receptor_shm_alloc(&zone->shm) != RECEPTOR_OK) {
+			receptor_set_error("Failed to map shared memory zone \"%s\"", (char*)zone->shm.name.data);
+			return RECEPTOR_ERROR;
+		}
+
+		zone->shm.exists = 0;
+
+		if (receptor_shm_slab_init(zone->shm.addr, zone->shm.size) == NULL
+			|| (zone->init && zone->init(zone, NULL) != RECEPTOR_OK))
+		{
+			receptor_set_error("Failed to initialize shared memory zone \"%s\"", (char*)zone->shm.name.data);
+			return RECEPTOR_ERROR;
+		}
+	}
+
+	return RECEPTOR_OK;
+}
+
+/* 解除 zones 中的映射，keep 中仍在使用的映射跳过 */
+static void
+receptor_free_zones(receptor_array_t* zones, receptor_array_t* keep)
+{
+	receptor_uint_t i, j;
+	receptor_shm_zone_t** z;
+	receptor_shm_zone_t** k;
+
+	if (zones == NULL) {
+		return;
+	}
+
+	z = (receptor_shm_zone_t**)zones->elts;
+
+	for (i = 0; i < zones->nelts; i++) {
+		if (z[i]->shm.addr == NULL) {
+			continue;
+		}
+
+		if (keep) {
+			k = (receptor_shm_zone_t**)keep->elts;
+
+			for (j = 0; j < keep->nelts; j++) {
+				if (k[j]->shm.addr == z[i]->shm.addr) {
+					break;
+				}
+			}
+
+			if (j < keep->nelts) {
+				continue;
+			}
+		}
+
+		receptor_shm_free(&z[i]->shm);
+	}
+}
+
 /* ==================== 内部函数实现 ==================== */
 
 static receptor_int_t
@@ -2,6 +2,7 @@
 #ifndef _RECEPTOR_H_
 #define _RECEPTOR_H_
 
+#include "receptor_shm.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -107,6 +108,18 @@ extern "C" {
 	 */
 	RECEPTOR_API receptor_core_conf_t* receptor_get_core_conf(receptor_cycle_t* cycle);
 
+	/**
+	 * @brief 登记命名共享内存区，应在模块的 init_module 中调用，
+	 *        receptor_start 和 receptor_reload 在模块初始化之后创建或沿用映射
+	 * @param cycle 周期结构
+	 * @param name 区名，同一周期内唯一
+	 * @param size 大小，按页向上取整，不小于 RECEPTOR_SHM_MIN_PAGES 页
+	 * @param tag 登记者标识，同名的区 tag 不同时报错
+	 * @return 区结构，调用方设置 init 和 noreuse；失败返回 NULL
+	 */
+	RECEPTOR_API receptor_shm_zone_t* receptor_shared_memory_add(receptor_cycle_t* cycle,
+		const char* name, size_t size, void* tag);
+
 	/* ==================== 模块管理 ==================== */
 
 	/**
@@ -154,7 +167,8 @@ extern "C" {
 	RECEPTOR_API receptor_int_t receptor_stop(receptor_cycle_t* cycle);
 
 	/**
-	 * @brief 重新加载配置
+	 * @brief 重新加载配置：重新初始化各模块，名称、大小和 tag
+	 *        都未变的共享内存区沿用原有映射，其余新建，不再登记的解除映射
 	 * @param cycle 周期结构
 	 * @return RECEPTOR_OK 成功, RECEPTOR_ERROR 失败
 	 */
@@ -190,7 +204,7 @@ extern "C" {
 	RECEPTOR_API receptor_int_t receptor_init_signals(void);
 
 	/**
-	 * @brief 添加信号处理
+	 * @brief 添加信号处理，信号经默认事件循环递送，处理函数在循环线程上执行
 	 * @param signum 信号编号
 	 * @param handler 信号处理函数
 	 * @return RECEPTOR_OK 成功, RECEPTOR_ERROR 失败
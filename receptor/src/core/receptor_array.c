@@ -77,6 +77,11 @@ receptor_array_push(receptor_array_t *array)
 			memcpy(new_elts, array->elts, array->nelts * array->size);
 		}
 
+		/* 旧缓冲区是单独申请的大块时立即归还，否则留在池中 */
+		if (array->elts) {
+			(void)receptor_pfree(array->pool, array->elts);
+		}
+
 		array->elts = new_elts;
 		array->nalloc = new_nalloc;
 	}
@@ -117,6 +122,11 @@ receptor_array_push_n(receptor_array_t *array, receptor_uint_t n)
 			memcpy(new_elts, array->elts, array->nelts * array->size);
 		}
 
+		/* 旧缓冲区是单独申请的大块时立即归还，否则留在池中 */
+		if (array->elts) {
+			(void)receptor_pfree(array->pool, array->elts);
+		}
+
 		array->elts = new_elts;
 		array->nalloc = new_nalloc;
 	}
@@ -0,0 +1,77 @@
+#ifndef _RECEPTOR_ATOMIC_H_
+#define _RECEPTOR_ATOMIC_H_
+
+#include <receptor/def.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 原子操作 ==================== */
+
+	/*
+	 * 只封装跨线程通信用到的几种操作：GCC/Clang 使用 __atomic 内建函数，
+	 * MSVC 使用 Interlocked 系列 (本身即全屏障)。
+	 * relaxed 读写只用于单写者的 uint64_t 计数器，保证读者不会读到撕裂的值；
+	 * fetch_add 用于多写者的 uint64_t 统计计数，同样不提供顺序保证。
+	 */
+
+#if defined(_MSC_VER)
+
+#define receptor_atomic_load_ptr(p)                                           \
+    InterlockedCompareExchangePointer((PVOID volatile *) (p), NULL, NULL)
+
+#define receptor_atomic_exchange_ptr(p, v)                                    \
+    InterlockedExchangePointer((PVOID volatile *) (p), (PVOID) (v))
+
+#define receptor_atomic_load_relaxed(p)                                       \
+    (*(volatile uint64_t *) (p))
+
+#define receptor_atomic_store_relaxed(p, v)                                   \
+    (*(volatile uint64_t *) (p) = (uint64_t) (v))
+
+#define receptor_atomic_fetch_add(p, v)                                       \
+    ((uint64_t) InterlockedExchangeAdd64((volatile LONG64 *) (p), (LONG64) (v)))
+
+	/* 成功返回非零，失败时 *old 更新为当前值 */
+	static RECEPTOR_INLINE int
+	receptor_atomic_cas_ptr(void *volatile *p, void **old, void *v)
+	{
+		void *cur;
+
+		cur = InterlockedCompareExchangePointer((PVOID volatile *)p, v, *old);
+		if (cur == *old) {
+			return 1;
+		}
+
+		*old = cur;
+		return 0;
+	}
+
+#else
+
+#define receptor_atomic_load_ptr(p)                                           \
+    __atomic_load_n(p, __ATOMIC_ACQUIRE)
+
+#define receptor_atomic_exchange_ptr(p, v)                                    \
+    __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL)
+
+#define receptor_atomic_cas_ptr(p, old, v)                                    \
+    __atomic_compare_exchange_n(p, old, v, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+
+#define receptor_atomic_load_relaxed(p)                                       \
+    __atomic_load_n(p, __ATOMIC_RELAXED)
+
+#define receptor_atomic_store_relaxed(p, v)                                   \
+    __atomic_store_n(p, v, __ATOMIC_RELAXED)
+
+#define receptor_atomic_fetch_add(p, v)                                       \
+    __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_ATOMIC_H_ */
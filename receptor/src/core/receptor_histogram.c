@@ -0,0 +1,142 @@
+#include <receptor/def.h>
+#include "receptor_histogram.h"
+#include "receptor_atomic.h"
+#include <string.h>
+
+#define RECEPTOR_HISTOGRAM_SUB_COUNT  (1 << RECEPTOR_HISTOGRAM_SUB_BITS)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static RECEPTOR_INLINE receptor_uint_t
+receptor_histogram_msb(uint64_t v)
+{
+	unsigned long i;
+
+	_BitScanReverse64(&i, v);
+	return (receptor_uint_t)i;
+}
+#else
+#define receptor_histogram_msb(v)  (receptor_uint_t)(63 - __builtin_clzll(v))
+#endif
+
+static receptor_uint_t
+receptor_histogram_index(uint64_t v)
+{
+	receptor_uint_t e;
+
+	if (v < RECEPTOR_HISTOGRAM_SUB_COUNT) {
+		return (receptor_uint_t)v;
+	}
+
+	e = receptor_histogram_msb(v);
+
+	if (e >= RECEPTOR_HISTOGRAM_MAX_BITS) {
+		return RECEPTOR_HISTOGRAM_BUCKETS - 1;
+	}
+
+	return ((e - RECEPTOR_HISTOGRAM_SUB_BITS + 1) << RECEPTOR_HISTOGRAM_SUB_BITS)
+		+ (receptor_uint_t)(v >> (e - RECEPTOR_HISTOGRAM_SUB_BITS)) - RECEPTOR_HISTOGRAM_SUB_COUNT;
+}
+
+/* 第 i 个桶能容纳的最大值 */
+static uint64_t
+receptor_histogram_upper(receptor_uint_t i)
+{
+	receptor_uint_t e, sub;
+
+	if (i < RECEPTOR_HISTOGRAM_SUB_COUNT) {
+		return i;
+	}
+
+	e = (i >> RECEPTOR_HISTOGRAM_SUB_BITS) + RECEPTOR_HISTOGRAM_SUB_BITS - 1;
+	sub = i & (RECEPTOR_HISTOGRAM_SUB_COUNT - 1);
+
+	return (((uint64_t)(RECEPTOR_HISTOGRAM_SUB_COUNT + sub + 1)) << (e - RECEPTOR_HISTOGRAM_SUB_BITS)) - 1;
+}
+
+RECEPTOR_API void
+receptor_histogram_reset(receptor_histogram_t *h)
+{
+	memset(h, 0, sizeof(receptor_histogram_t));
+}
+
+/* 单写者，读改写不需要原子指令，只需保证每个字段的写入对读者是完整的 */
+RECEPTOR_API void
+receptor_histogram_record(receptor_histogram_t *h, uint64_t value)
+{
+	uint64_t *b;
+
+	b = &h->buckets[receptor_histogram_index(value)];
+
+	receptor_atomic_store_relaxed(b, *b + 1);
+	receptor_atomic_store_relaxed(&h->sum, h->sum + value);
+
+	if (value > h->max) {
+		receptor_atomic_store_relaxed(&h->max, value);
+	}
+
+	receptor_atomic_store_relaxed(&h->count, h->count + 1);
+}
+
+RECEPTOR_API void
+receptor_histogram_snapshot(const receptor_histogram_t *h, receptor_histogram_t *snap)
+{
+	receptor_uint_t i;
+
+	snap->count = receptor_atomic_load_relaxed(&h->count);
+	snap->sum = receptor_atomic_load_relaxed(&h->sum);
+	snap->max = receptor_atomic_load_relaxed(&h->max);
+
+	for (i = 0; i < RECEPTOR_HISTOGRAM_BUCKETS; i++) {
+		snap->buckets[i] = receptor_atomic_load_relaxed(&h->buckets[i]);
+	}
+}
+
+RECEPTOR_API uint64_t
+receptor_histogram_percentile(const receptor_histogram_t *h, double percentile)
+{
+	receptor_uint_t     i;
+	uint64_t            total, rank, seen, upper, max;
+
+	total = 0;
+
+	for (i = 0; i < RECEPTOR_HISTOGRAM_BUCKETS; i++) {
+		total += receptor_atomic_load_relaxed(&h->buckets[i]);
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	if (percentile < 0) {
+		percentile = 0;
+	}
+	else if (percentile > 100) {
+		percentile = 100;
+	}
+
+	rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	max = receptor_atomic_load_relaxed(&h->max);
+	seen = 0;
+
+	for (i = 0; i < RECEPTOR_HISTOGRAM_BUCKETS; i++) {
+		seen += receptor_atomic_load_relaxed(&h->buckets[i]);
+
+		if (seen >= rank) {
+			/* 最后一个桶没有上界，用最大值代替 */
+			if (i == RECEPTOR_HISTOGRAM_BUCKETS - 1) {
+				return max;
+			}
+
+			upper = receptor_histogram_upper(i);
+			return (max && upper > max) ? max : upper;
+		}
+	}
+
+	return max;
+}
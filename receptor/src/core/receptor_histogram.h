@@ -0,0 +1,70 @@
+#ifndef _RECEPTOR_HISTOGRAM_H_
+#define _RECEPTOR_HISTOGRAM_H_
+
+#include "receptor/def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 对数线性直方图 ==================== */
+
+	/**
+	 * HDR 风格的直方图：每个 2 的幂区间再等分为 16 个子桶，
+	 * 相对误差不超过 1/16，小于 16 的值精确记录，不小于 2^40 的值计入最后一个桶。
+	 * 只允许一个线程写入，其它线程可以随时无锁读取 (各字段单独原子，
+	 * 读到的快照在字段之间可能相差正在记录的那一个样本)。
+	 */
+#define RECEPTOR_HISTOGRAM_SUB_BITS   4
+#define RECEPTOR_HISTOGRAM_MAX_BITS   40
+#define RECEPTOR_HISTOGRAM_BUCKETS                                            \
+    ((RECEPTOR_HISTOGRAM_MAX_BITS - RECEPTOR_HISTOGRAM_SUB_BITS + 1) << RECEPTOR_HISTOGRAM_SUB_BITS)
+
+	typedef struct receptor_histogram_s receptor_histogram_t;
+
+	struct receptor_histogram_s {
+		uint64_t        count;
+		uint64_t        sum;
+		uint64_t        max;
+		uint64_t        buckets[RECEPTOR_HISTOGRAM_BUCKETS];
+	};
+
+	/* ==================== 直方图操作API ==================== */
+
+	/**
+	 * @brief 清零，只能在写入线程或没有写入时调用
+	 * @param h 直方图
+	 */
+	RECEPTOR_API void
+		receptor_histogram_reset(receptor_histogram_t *h);
+
+	/**
+	 * @brief 记录一个样本
+	 * @param h 直方图
+	 * @param value 样本值
+	 */
+	RECEPTOR_API void
+		receptor_histogram_record(receptor_histogram_t *h, uint64_t value);
+
+	/**
+	 * @brief 复制一份快照，可在任意线程调用
+	 * @param h 直方图
+	 * @param snap 输出快照
+	 */
+	RECEPTOR_API void
+		receptor_histogram_snapshot(const receptor_histogram_t *h, receptor_histogram_t *snap);
+
+	/**
+	 * @brief 取百分位数，返回所在桶的上界，可在任意线程调用
+	 * @param h 直方图
+	 * @param percentile 0 到 100
+	 * @return 样本值，没有样本时返回 0
+	 */
+	RECEPTOR_API uint64_t
+		receptor_histogram_percentile(const receptor_histogram_t *h, double percentile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_HISTOGRAM_H_ */
@@ -1,12 +1,32 @@
 #include <receptor/def.h>
 #include "receptor_list.h"
+#include "receptor_slab.h"
 #include <string.h>
 #include <stdlib.h>
 
+/* 节点与定长数据放在同一个 slab 对象里，数据按 16 字节对齐 */
+#define RECEPTOR_LIST_NODE_SIZE                                               \
+    ((sizeof(receptor_list_node_t) + 15) & ~(size_t) 15)
+
+static void
+receptor_list_cleanup(void *data)
+{
+	receptor_list_clear(data);
+}
+
+static void
+receptor_list_free_node(receptor_list_t *list, receptor_list_node_t *node)
+{
+	if (list->slab) {
+		receptor_slab_free(node);
+	}
+}
+
 RECEPTOR_API receptor_list_t*
 receptor_list_create(receptor_pool_t *pool, size_t data_size)
 {
 	receptor_list_t *list;
+	receptor_pool_cleanup_t *cln;
 
 	if (pool == NULL) {
 		return NULL;
@@ -22,6 +42,18 @@ receptor_list_create(receptor_pool_t *pool, size_t data_size)
 	list->size = 0;
 	list->pool = pool;
 	list->data_size = data_size;
+	list->slab = (RECEPTOR_LIST_NODE_SIZE + data_size <= RECEPTOR_SLAB_MAX_SIZE);
+
+	/* 池销毁时把仍在链表中的节点还给 slab */
+	if (list->slab) {
+		cln = receptor_pool_cleanup_add(pool, 0);
+		if (cln == NULL) {
+			return NULL;
+		}
+
+		cln->handler = receptor_list_cleanup;
+		cln->data = list;
+	}
 
 	return list;
 }
@@ -43,16 +75,28 @@ receptor_list_create_node(receptor_list_t *list, const void *data)
 	receptor_list_node_t *node;
 	void *node_data;
 
-	node = receptor_pcalloc(list->pool, sizeof(receptor_list_node_t));
+	if (list->slab) {
+		node = receptor_slab_alloc(RECEPTOR_LIST_NODE_SIZE + list->data_size);
+	}
+	else {
+		node = receptor_palloc(list->pool, sizeof(receptor_list_node_t));
+	}
+
 	if (node == NULL) {
 		return NULL;
 	}
 
 	if (list->data_size > 0) {
-		node_data = receptor_palloc(list->pool, list->data_size);
-		if (node_data == NULL) {
-			return NULL;
+		if (list->slab) {
+			node_data = (char *)node + RECEPTOR_LIST_NODE_SIZE;
+		}
+		else {
+			node_data = receptor_palloc(list->pool, list->data_size);
+			if (node_data == NULL) {
+				return NULL;
+			}
 		}
+
 		if (data) {
 			memcpy(node_data, data, list->data_size);
 		}
@@ -153,6 +197,7 @@ receptor_list_pop_front(receptor_list_t *list, void *data)
 		list->head->prev = NULL;
 	}
 
+	receptor_list_free_node(list, node);
 	list->size--;
 	return RECEPTOR_OK;
 }
@@ -182,6 +227,7 @@ receptor_list_pop_back(receptor_list_t *list, void *data)
 		list->tail->next = NULL;
 	}
 
+	receptor_list_free_node(list, node);
 	list->size--;
 	return RECEPTOR_OK;
 }
@@ -196,11 +242,6 @@ receptor_list_insert(receptor_list_t *list, receptor_list_iter_t *iter,
 		return RECEPTOR_ERROR;
 	}
 
-	node = receptor_list_create_node(list, data);
-	if (node == NULL) {
-		return RECEPTOR_ERROR;
-	}
-
 	current = iter->current;
 
 	if (current == list->head) {
@@ -208,6 +249,11 @@ receptor_list_insert(receptor_list_t *list, receptor_list_iter_t *iter,
 		return receptor_list_push_front(list, data);
 	}
 
+	node = receptor_list_create_node(list, data);
+	if (node == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
 	/* 在中间插入 */
 	node->prev = current->prev;
 	node->next = current;
@@ -238,6 +284,7 @@ receptor_list_erase(receptor_list_t *list, receptor_list_iter_t *iter)
 	else {
 		node->prev->next = node->next;
 		node->next->prev = node->prev;
+		receptor_list_free_node(list, node);
 		list->size--;
 	}
 
@@ -294,7 +341,8 @@ receptor_list_clear(receptor_list_t *list)
 	node = list->head;
 	while (node != NULL) {
 		next = node->next;
-		/* 内存池会自动释放内存 */
+		/* 池分配的节点随内存池释放 */
+		receptor_list_free_node(list, node);
 		node = next;
 	}
 
@@ -34,6 +34,7 @@ extern "C" {
 		receptor_uint_t         size;      /* 链表大小 */
 		receptor_pool_t        *pool;      /* 内存池 */
 		size_t                  data_size; /* 数据大小（0表示动态大小） */
+		receptor_uint_t         slab;      /* 节点从 slab 分配，删除时归还 */
 	};
 
 	/* ==================== 链表迭代器定义 ==================== */
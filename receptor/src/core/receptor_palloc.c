@@ -1,25 +1,153 @@
 #include <receptor/def.h>
 #include "receptor_palloc.h"
+#include "receptor_atomic.h"
+#include "receptor_slab.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define RECEPTOR_DEFAULT_POOL_SIZE    (16 * 1024)
 #define RECEPTOR_POOL_ALIGNMENT       16
-#define RECEPTOR_MAX_ALLOC_FROM_POOL  (RECEPTOR_DEFAULT_POOL_SIZE - 1)
+
+/* 小分配从块头之后切出，上限要扣掉对齐后的块头 */
+#define RECEPTOR_MAX_ALLOC_FROM_POOL                                          \
+    (RECEPTOR_DEFAULT_POOL_SIZE                                               \
+     - receptor_align(sizeof(receptor_pool_t), RECEPTOR_POOL_ALIGNMENT))
+
+/* 块头之外至少还能放下若干小分配 */
+#define RECEPTOR_MIN_POOL_SIZE        1024
+
+/* 连续放不下这么多次后，current 越过该块 */
+#define RECEPTOR_POOL_MAX_FAILED      4
+
+/* 新的大块分配先查看链表头部这么多个节点，复用已释放的节点 */
+#define RECEPTOR_POOL_LARGE_REUSE     3
+
+#define receptor_align(d, a)     (((d) + ((a) - 1)) & ~((a) - 1))
+#define receptor_align_ptr(p, a)                                              \
+    (char *) (((uintptr_t) (p) + ((uintptr_t) (a) - 1)) & ~((uintptr_t) (a) - 1))
 
 #ifdef _WIN32
 #include <malloc.h>
+#include <io.h>
+#include <stdio.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#define RECEPTOR_POOL_ARENA           1
+#endif
+
+#ifdef RECEPTOR_POOL_ARENA
+
+#include <sys/syscall.h>
+
+/*
+ * 大页区域：每个线程按 2MB 对齐 mmap 区域，建议内核用透明大页，
+ * 并优先放在线程当前所在的 NUMA 节点上；区域切成池块大小的块，
+ * 第一块存放区域头。释放时由地址找到区域，本线程释放进空闲链表，
+ * 其它线程释放以 CAS 压入区域的远程栈，所有者缺块时取回。
+ * 区域不归还系统，线程退出时交给下一个缺块的线程接管。
+ */
+#define RECEPTOR_POOL_ARENA_SIZE      (2 * 1024 * 1024)
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED                1
+#endif
+
+#define receptor_pool_arena_of(p)                                             \
+    ((receptor_pool_arena_t *) ((uintptr_t) (p) & ~((uintptr_t) RECEPTOR_POOL_ARENA_SIZE - 1)))
+
+typedef struct receptor_pool_block_s  receptor_pool_block_t;
+typedef struct receptor_pool_arena_s  receptor_pool_arena_t;
+
+struct receptor_pool_block_s {
+	receptor_pool_block_t      *next;
+};
+
+struct receptor_pool_arena_s {
+	void                       *owner;     /* 所属线程的 receptor_pool_arenas，交出后为 NULL */
+	receptor_pool_arena_t      *next;      /* 所属线程的区域链表，交出后串在全局栈上 */
+
+	/* 其它线程释放的块 */
+	RECEPTOR_CACHELINE_ALIGNED receptor_pool_block_t *volatile remote;
+};
+
+typedef struct {
+	receptor_pool_block_t      *free;
+	receptor_pool_arena_t      *arenas;
+} receptor_pool_arenas_t;
+
+static __thread receptor_pool_arenas_t  receptor_pool_arenas;
+static receptor_pool_arena_t *volatile  receptor_pool_abandoned;
+
+static void *receptor_pool_arena_alloc(void);
+static void receptor_pool_arena_free(void *p);
+
+#endif
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+
+static receptor_pool_stats_t  receptor_pool_global;
+
+#define receptor_pool_stat_add(pool, field, n)                                \
+    do {                                                                      \
+        (pool)->stats.field += (n);                                           \
+        (void) receptor_atomic_fetch_add(&receptor_pool_global.field, (uint64_t) (n)); \
+    } while (0)
+
+static void receptor_pool_stat_size(receptor_pool_t *pool, size_t n, receptor_uint_t grow);
+static uint64_t receptor_pool_tail(receptor_pool_t *pool);
+
+#else
+
+#define receptor_pool_stat_add(pool, field, n)
+
 #endif
 
 static void *receptor_memalign(size_t alignment, size_t size);
+static void receptor_memalign_free(void *p);
+static void *receptor_palloc_large(receptor_pool_t *pool, size_t size);
+static void *receptor_palloc_small(receptor_pool_t *pool, size_t size, receptor_uint_t align);
+static void *receptor_palloc_block(receptor_pool_t *pool, size_t size);
+
+static receptor_pool_t *
+receptor_pool_init(receptor_pool_t *p, size_t size, receptor_uint_t arena)
+{
+	p->last = (char *)p + sizeof(receptor_pool_t);
+	p->end = (char *)p + size;
+	p->next = NULL;
+	p->failed = 0;
+	p->current = p;
+	p->large = NULL;
+	p->cleanup = NULL;
+	p->arena = arena;
+	p->block = size;
+	p->block_max = 0;
+
+	/* 任何一个新块都要能放下不超过 max 的分配 */
+	p->max = size - receptor_align(sizeof(receptor_pool_t), RECEPTOR_POOL_ALIGNMENT);
+	if (p->max > RECEPTOR_MAX_ALLOC_FROM_POOL) {
+		p->max = RECEPTOR_MAX_ALLOC_FROM_POOL;
+	}
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+	memset(&p->stats, 0, sizeof(receptor_pool_stats_t));
+	(void)receptor_atomic_fetch_add(&receptor_pool_global.pools, 1);
+	receptor_pool_stat_add(p, blocks, 1);
+	receptor_pool_stat_size(p, size, 1);
+#endif
+
+	return p;
+}
 
 receptor_pool_t *
 receptor_create_pool(size_t size)
 {
 	receptor_pool_t  *p;
 
-	if (size < RECEPTOR_DEFAULT_POOL_SIZE) {
-		size = RECEPTOR_DEFAULT_POOL_SIZE;
+	if (size < RECEPTOR_MIN_POOL_SIZE) {
+		size = RECEPTOR_MIN_POOL_SIZE;
 	}
 
 	p = receptor_memalign(RECEPTOR_POOL_ALIGNMENT, size);
@@ -27,21 +155,82 @@ receptor_create_pool(size_t size)
 		return NULL;
 	}
 
-	p->last = (char *)p + sizeof(receptor_pool_t);
-	p->end = (char *)p + size;
-	p->next = NULL;
-	p->failed = 0;
+	return receptor_pool_init(p, size, 0);
+}
 
-	return p;
+receptor_pool_t *
+receptor_create_pool_arena(void)
+{
+#ifdef RECEPTOR_POOL_ARENA
+	receptor_pool_t  *p;
+
+	p = receptor_pool_arena_alloc();
+	if (p == NULL) {
+		return NULL;
+	}
+
+	return receptor_pool_init(p, RECEPTOR_DEFAULT_POOL_SIZE, 1);
+#else
+	return receptor_create_pool(RECEPTOR_DEFAULT_POOL_SIZE);
+#endif
+}
+
+void
+receptor_pool_set_growth(receptor_pool_t *pool, size_t max)
+{
+	/* 区域的块大小固定 */
+	if (pool->arena) {
+		return;
+	}
+
+	pool->block_max = (max > pool->block) ? max : 0;
 }
 
 void
 receptor_destroy_pool(receptor_pool_t *pool)
 {
-	receptor_pool_t  *p, *n;
+	receptor_pool_t          *p, *n;
+	receptor_pool_large_t    *l;
+	receptor_pool_cleanup_t  *c;
+#ifdef RECEPTOR_POOL_ARENA
+	receptor_uint_t           arena;
+#endif
+
+	/* 先运行清理函数，它们可能还会访问池中的数据 */
+	for (c = pool->cleanup; c; c = c->next) {
+		if (c->handler) {
+			c->handler(c->data);
+		}
+	}
+
+	for (l = pool->large; l; l = l->next) {
+		if (l->alloc) {
+			receptor_memalign_free(l->alloc);
+		}
+	}
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+	(void)receptor_atomic_fetch_add(&receptor_pool_global.tail, receptor_pool_tail(pool));
+	(void)receptor_atomic_fetch_add(&receptor_pool_global.size, (uint64_t)0 - pool->stats.size);
+	(void)receptor_atomic_fetch_add(&receptor_pool_global.pools, (uint64_t)0 - 1);
+#endif
+
+#ifdef RECEPTOR_POOL_ARENA
+	/* 第一块在循环中最先释放，先取出标志 */
+	arena = pool->arena;
+#endif
 
 	for (p = pool, n = pool->next; /* void */; p = n, n = n->next) {
-		free(p);
+#ifdef RECEPTOR_POOL_ARENA
+		if (arena) {
+			receptor_pool_arena_free(p);
+		}
+		else {
+			receptor_memalign_free(p);
+		}
+#else
+		receptor_memalign_free(p);
+#endif
 
 		if (n == NULL) {
 			break;
@@ -49,37 +238,82 @@ receptor_destroy_pool(receptor_pool_t *pool)
 	}
 }
 
-void *
-receptor_palloc(receptor_pool_t *pool, size_t size)
+void
+receptor_reset_pool(receptor_pool_t *pool)
 {
-	receptor_pool_t  *p, *new_p;
+	receptor_pool_t          *p;
+	receptor_pool_large_t    *l;
+	receptor_pool_cleanup_t  *c;
 
-	if (size <= RECEPTOR_MAX_ALLOC_FROM_POOL) {
-		for (p = pool; p; p = p->next) {
-			if ((size_t)(p->end - p->last) >= size) {
-				void *ptr = p->last;
-				p->last += size;
-				return ptr;
-			}
+	/* 清理节点和大块链表都分配在池里，先处理再回绕 */
+	for (c = pool->cleanup; c; c = c->next) {
+		if (c->handler) {
+			c->handler(c->data);
 		}
+	}
 
-		/* 需要创建新的pool块 */
-		new_p = receptor_create_pool(RECEPTOR_DEFAULT_POOL_SIZE);
-		if (new_p == NULL) {
-			return NULL;
+	for (l = pool->large; l; l = l->next) {
+		if (l->alloc) {
+			receptor_memalign_free(l->alloc);
+#ifdef RECEPTOR_DEBUG_ALLOC
+			receptor_pool_stat_size(pool, l->size, 0);
+#endif
 		}
+	}
 
-		/* 添加到链表 */
-		for (p = pool; p->next; p = p->next) { /* void */ }
-		p->next = new_p;
+#ifdef RECEPTOR_DEBUG_ALLOC
+	(void)receptor_atomic_fetch_add(&receptor_pool_global.tail, receptor_pool_tail(pool));
+#endif
 
-		void *ptr = new_p->last;
-		new_p->last += size;
-		return ptr;
+	/* 保留所有块，下一轮分配不再向系统申请 */
+	for (p = pool; p; p = p->next) {
+		p->last = (char *)p + sizeof(receptor_pool_t);
+		p->failed = 0;
+	}
+
+	pool->current = pool;
+	pool->large = NULL;
+	pool->cleanup = NULL;
+}
+
+void *
+receptor_palloc(receptor_pool_t *pool, size_t size)
+{
+	if (size <= pool->max) {
+		return receptor_palloc_small(pool, size, 1);
 	}
 
-	/* 大内存分配 */
-	return receptor_memalign(RECEPTOR_POOL_ALIGNMENT, size);
+	return receptor_palloc_large(pool, size);
+}
+
+void *
+receptor_pnalloc(receptor_pool_t *pool, size_t size)
+{
+	if (size <= pool->max) {
+		return receptor_palloc_small(pool, size, 0);
+	}
+
+	return receptor_palloc_large(pool, size);
+}
+
+receptor_int_t
+receptor_pfree(receptor_pool_t *pool, void *p)
+{
+	receptor_pool_large_t *l;
+
+	for (l = pool->large; l; l = l->next) {
+		if (p == l->alloc) {
+			receptor_memalign_free(l->alloc);
+			l->alloc = NULL;
+#ifdef RECEPTOR_DEBUG_ALLOC
+			receptor_pool_stat_size(pool, l->size, 0);
+#endif
+
+			return RECEPTOR_OK;
+		}
+	}
+
+	return RECEPTOR_ERROR;
 }
 
 void *
@@ -92,6 +326,220 @@ receptor_pcalloc(receptor_pool_t *pool, size_t size)
 	return p;
 }
 
+static void *
+receptor_palloc_small(receptor_pool_t *pool, size_t size, receptor_uint_t align)
+{
+	char             *m;
+	receptor_pool_t  *p;
+
+	for (p = pool->current; p; p = p->next) {
+		m = p->last;
+
+		if (align) {
+			m = receptor_align_ptr(m, RECEPTOR_POOL_ALIGNMENT);
+		}
+
+		if (m <= p->end && (size_t)(p->end - m) >= size) {
+			receptor_pool_stat_add(pool, requested, size);
+			receptor_pool_stat_add(pool, align, m - p->last);
+			p->last = m + size;
+			return m;
+		}
+	}
+
+	return receptor_palloc_block(pool, size);
+}
+
+/*
+ * 追加一个新块，大小取 pool->block，开启增长时之后的块依次加倍；
+ * 沿途每块记一次失败，失败过多的块不再参与查找
+ */
+static void *
+receptor_palloc_block(receptor_pool_t *pool, size_t size)
+{
+	char             *m;
+	size_t            bs;
+	receptor_pool_t  *p, *new_p;
+
+	bs = pool->block;
+
+#ifdef RECEPTOR_POOL_ARENA
+	if (pool->arena) {
+		new_p = receptor_pool_arena_alloc();
+	}
+	else {
+		new_p = receptor_memalign(RECEPTOR_POOL_ALIGNMENT, bs);
+	}
+#else
+	new_p = receptor_memalign(RECEPTOR_POOL_ALIGNMENT, bs);
+#endif
+	if (new_p == NULL) {
+		return NULL;
+	}
+
+	if (pool->block_max && bs < pool->block_max) {
+		pool->block = (bs * 2 < pool->block_max) ? bs * 2 : pool->block_max;
+	}
+
+	new_p->end = (char *)new_p + bs;
+	new_p->next = NULL;
+	new_p->failed = 0;
+	new_p->current = NULL;
+
+	m = receptor_align_ptr((char *)new_p + sizeof(receptor_pool_t), RECEPTOR_POOL_ALIGNMENT);
+	new_p->last = m + size;
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+	receptor_pool_stat_add(pool, blocks, 1);
+	receptor_pool_stat_add(pool, requested, size);
+	receptor_pool_stat_add(pool, align, m - ((char *)new_p + sizeof(receptor_pool_t)));
+	receptor_pool_stat_size(pool, bs, 1);
+#endif
+
+	for (p = pool->current; p->next; p = p->next) {
+		if (p->failed++ > RECEPTOR_POOL_MAX_FAILED) {
+			pool->current = p->next;
+		}
+	}
+
+	p->next = new_p;
+
+	return m;
+}
+
+receptor_pool_cleanup_t *
+receptor_pool_cleanup_add(receptor_pool_t *pool, size_t size)
+{
+	receptor_pool_cleanup_t *c;
+
+	c = receptor_palloc(pool, sizeof(receptor_pool_cleanup_t));
+	if (c == NULL) {
+		return NULL;
+	}
+
+	if (size) {
+		c->data = receptor_palloc(pool, size);
+		if (c->data == NULL) {
+			return NULL;
+		}
+	}
+	else {
+		c->data = NULL;
+	}
+
+	c->handler = NULL;
+	c->next = pool->cleanup;
+	pool->cleanup = c;
+
+	return c;
+}
+
+void
+receptor_pool_run_cleanup_file(receptor_pool_t *pool, int fd)
+{
+	receptor_pool_cleanup_t       *c;
+	receptor_pool_cleanup_file_t  *cf;
+
+	for (c = pool->cleanup; c; c = c->next) {
+		if (c->handler == receptor_pool_cleanup_file) {
+			cf = c->data;
+
+			if (cf->fd == fd) {
+				c->handler(cf);
+				c->handler = NULL;
+				return;
+			}
+		}
+	}
+}
+
+void
+receptor_pool_cleanup_file(void *data)
+{
+	receptor_pool_cleanup_file_t *cf = data;
+
+#ifdef _WIN32
+	_close(cf->fd);
+#else
+	close(cf->fd);
+#endif
+}
+
+/* 关闭并删除临时文件 */
+void
+receptor_pool_delete_file(void *data)
+{
+	receptor_pool_cleanup_file_t *cf = data;
+
+#ifdef _WIN32
+	_close(cf->fd);
+	remove(cf->name);
+#else
+	close(cf->fd);
+	unlink(cf->name);
+#endif
+}
+
+void
+receptor_pool_cleanup_mmap(void *data)
+{
+	receptor_pool_cleanup_mmap_t *cm = data;
+
+#ifdef _WIN32
+	UnmapViewOfFile(cm->addr);
+#else
+	munmap(cm->addr, cm->size);
+#endif
+}
+
+/* 大内存单独申请，登记到 large 链表，链表节点本身从池中分配 */
+static void *
+receptor_palloc_large(receptor_pool_t *pool, size_t size)
+{
+	void                   *p;
+	receptor_uint_t         n;
+	receptor_pool_large_t  *large;
+
+	p = receptor_memalign(RECEPTOR_POOL_ALIGNMENT, size);
+	if (p == NULL) {
+		return NULL;
+	}
+
+	n = 0;
+
+	for (large = pool->large; large; large = large->next) {
+		if (large->alloc == NULL) {
+			goto found;
+		}
+
+		if (n++ > RECEPTOR_POOL_LARGE_REUSE) {
+			break;
+		}
+	}
+
+	large = receptor_palloc_small(pool, sizeof(receptor_pool_large_t), 1);
+	if (large == NULL) {
+		receptor_memalign_free(p);
+		return NULL;
+	}
+
+	large->next = pool->large;
+	pool->large = large;
+
+found:
+
+	large->alloc = p;
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+	large->size = size;
+	receptor_pool_stat_add(pool, large, 1);
+	receptor_pool_stat_add(pool, requested, size);
+	receptor_pool_stat_size(pool, size, 1);
+#endif
+
+	return p;
+}
+
 static void *
 receptor_memalign(size_t alignment, size_t size)
 {
@@ -108,4 +556,289 @@ receptor_memalign(size_t alignment, size_t size)
 #endif
 
 	return p;
-}
\ No newline at end of file
+}
+
+static void
+receptor_memalign_free(void *p)
+{
+#ifdef _WIN32
+	/* _aligned_malloc 的内存必须用 _aligned_free 释放 */
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+
+/* 调整当前占用，增长时更新池和全局的峰值 */
+static void
+receptor_pool_stat_size(receptor_pool_t *pool, size_t n, receptor_uint_t grow)
+{
+	uint64_t size;
+
+	if (!grow) {
+		pool->stats.size -= n;
+		(void)receptor_atomic_fetch_add(&receptor_pool_global.size, (uint64_t)0 - n);
+		return;
+	}
+
+	pool->stats.size += n;
+
+	if (pool->stats.size > pool->stats.peak) {
+		pool->stats.peak = pool->stats.size;
+	}
+
+	size = receptor_atomic_fetch_add(&receptor_pool_global.size, (uint64_t)n) + n;
+
+	if (size > receptor_atomic_load_relaxed(&receptor_pool_global.peak)) {
+		receptor_atomic_store_relaxed(&receptor_pool_global.peak, size);
+	}
+}
+
+static uint64_t
+receptor_pool_tail(receptor_pool_t *pool)
+{
+	uint64_t          tail;
+	receptor_pool_t  *p;
+
+	tail = 0;
+
+	for (p = pool; p; p = p->next) {
+		tail += (uint64_t)(p->end - p->last);
+	}
+
+	return tail;
+}
+
+void
+receptor_pool_get_stats(receptor_pool_t *pool, receptor_pool_stats_t *stats)
+{
+	receptor_pool_stats_t *g = &receptor_pool_global;
+
+	if (pool) {
+		*stats = pool->stats;
+		stats->pools = 1;
+		stats->tail = receptor_pool_tail(pool);
+		return;
+	}
+
+	stats->pools = receptor_atomic_load_relaxed(&g->pools);
+	stats->requested = receptor_atomic_load_relaxed(&g->requested);
+	stats->align = receptor_atomic_load_relaxed(&g->align);
+	stats->tail = receptor_atomic_load_relaxed(&g->tail);
+	stats->blocks = receptor_atomic_load_relaxed(&g->blocks);
+	stats->large = receptor_atomic_load_relaxed(&g->large);
+	stats->size = receptor_atomic_load_relaxed(&g->size);
+	stats->peak = receptor_atomic_load_relaxed(&g->peak);
+}
+
+void
+receptor_pool_dump(receptor_pool_t *pool, FILE *fp)
+{
+	receptor_pool_stats_t st;
+
+	receptor_pool_get_stats(pool, &st);
+
+	fprintf(fp, "pool %s: pools=%llu requested=%llu align=%llu tail=%llu"
+		" blocks=%llu large=%llu size=%llu peak=%llu\n",
+		pool ? "local" : "global",
+		(unsigned long long)st.pools, (unsigned long long)st.requested,
+		(unsigned long long)st.align, (unsigned long long)st.tail,
+		(unsigned long long)st.blocks, (unsigned long long)st.large,
+		(unsigned long long)st.size, (unsigned long long)st.peak);
+}
+
+#endif
+
+#ifdef RECEPTOR_POOL_ARENA
+
+static void
+receptor_pool_arena_collect(receptor_pool_arenas_t *cache, receptor_pool_arena_t *a)
+{
+	receptor_pool_block_t *head, *b;
+
+	if (receptor_atomic_load_ptr(&a->remote) == NULL) {
+		return;
+	}
+
+	head = receptor_atomic_exchange_ptr(&a->remote, NULL);
+	if (head == NULL) {
+		return;
+	}
+
+	for (b = head; b->next; b = b->next) {
+		/* void */
+	}
+
+	b->next = cache->free;
+	cache->free = head;
+}
+
+static receptor_pool_arena_t *
+receptor_pool_arena_create(receptor_pool_arenas_t *cache)
+{
+	char                   *p, *m, *end;
+	unsigned                cpu, node;
+	unsigned long           mask;
+	receptor_pool_block_t  *b;
+	receptor_pool_arena_t  *a;
+
+	/* 多映射一个区域大小，截掉首尾得到对齐的区域 */
+	p = mmap(NULL, 2 * RECEPTOR_POOL_ARENA_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED) {
+		return NULL;
+	}
+
+	m = receptor_align_ptr(p, RECEPTOR_POOL_ARENA_SIZE);
+	end = p + 2 * RECEPTOR_POOL_ARENA_SIZE;
+
+	if (m != p) {
+		munmap(p, m - p);
+	}
+
+	if (m + RECEPTOR_POOL_ARENA_SIZE != end) {
+		munmap(m + RECEPTOR_POOL_ARENA_SIZE, end - (m + RECEPTOR_POOL_ARENA_SIZE));
+	}
+
+	/* 以下两项都只是建议，内核不支持或没有权限时忽略 */
+#ifdef MADV_HUGEPAGE
+	(void)madvise(m, RECEPTOR_POOL_ARENA_SIZE, MADV_HUGEPAGE);
+#endif
+
+#if defined(SYS_getcpu) && defined(SYS_mbind)
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0 && node < sizeof(mask) * 8) {
+		mask = 1UL << node;
+		(void)syscall(SYS_mbind, m, (unsigned long)RECEPTOR_POOL_ARENA_SIZE,
+			MPOL_PREFERRED, &mask, (unsigned long)(sizeof(mask) * 8 + 1), 0);
+	}
+#else
+	(void)cpu;
+	(void)node;
+	(void)mask;
+#endif
+
+	a = (receptor_pool_arena_t *)m;
+	a->owner = cache;
+	a->remote = NULL;
+	a->next = cache->arenas;
+	cache->arenas = a;
+
+	/* 倒序切块，先分配的块地址较低 */
+	for (p = m + RECEPTOR_POOL_ARENA_SIZE - RECEPTOR_DEFAULT_POOL_SIZE;
+		p > m;
+		p -= RECEPTOR_DEFAULT_POOL_SIZE)
+	{
+		b = (receptor_pool_block_t *)p;
+		b->next = cache->free;
+		cache->free = b;
+	}
+
+	return a;
+}
+
+static void *
+receptor_pool_arena_alloc(void)
+{
+	receptor_pool_block_t   *b;
+	receptor_pool_arena_t   *a, *next;
+	receptor_pool_arenas_t  *cache = &receptor_pool_arenas;
+
+	if (cache->free == NULL) {
+
+		/* 线程退出时自动交出区域，只在缺块时登记，开销可以忽略 */
+		receptor_slab_thread_register();
+
+		for (a = cache->arenas; a; a = a->next) {
+			receptor_pool_arena_collect(cache, a);
+		}
+
+		/* 接管退出线程交出的区域 */
+		if (cache->free == NULL && receptor_atomic_load_ptr(&receptor_pool_abandoned) != NULL) {
+			a = receptor_atomic_exchange_ptr(&receptor_pool_abandoned, NULL);
+
+			for ( /* void */; a; a = next) {
+				next = a->next;
+
+				(void)receptor_atomic_exchange_ptr(&a->owner, cache);
+				a->next = cache->arenas;
+				cache->arenas = a;
+
+				receptor_pool_arena_collect(cache, a);
+			}
+		}
+
+		if (cache->free == NULL && receptor_pool_arena_create(cache) == NULL) {
+			return NULL;
+		}
+	}
+
+	b = cache->free;
+	cache->free = b->next;
+
+	return b;
+}
+
+static void
+receptor_pool_arena_free(void *p)
+{
+	receptor_pool_block_t  *b = p;
+	receptor_pool_block_t  *head;
+	receptor_pool_arena_t  *a;
+
+	a = receptor_pool_arena_of(p);
+
+	if (receptor_atomic_load_ptr(&a->owner) == &receptor_pool_arenas) {
+		b->next = receptor_pool_arenas.free;
+		receptor_pool_arenas.free = b;
+		return;
+	}
+
+	head = receptor_atomic_load_ptr(&a->remote);
+	do {
+		b->next = head;
+	} while (!receptor_atomic_cas_ptr((void *volatile *)&a->remote, (void **)&head, b));
+}
+
+void
+receptor_pool_arena_thread_done(void)
+{
+	receptor_pool_block_t   *b, *head;
+	receptor_pool_arena_t   *a, *next, *top;
+	receptor_pool_arenas_t  *cache = &receptor_pool_arenas;
+
+	/* 空闲块还给各自区域的远程栈，接管者取回 */
+	while (cache->free) {
+		b = cache->free;
+		cache->free = b->next;
+
+		a = receptor_pool_arena_of(b);
+		head = receptor_atomic_load_ptr(&a->remote);
+		do {
+			b->next = head;
+		} while (!receptor_atomic_cas_ptr((void *volatile *)&a->remote, (void **)&head, b));
+	}
+
+	for (a = cache->arenas; a; a = next) {
+		next = a->next;
+
+		(void)receptor_atomic_exchange_ptr(&a->owner, NULL);
+
+		top = receptor_atomic_load_ptr(&receptor_pool_abandoned);
+		do {
+			a->next = top;
+		} while (!receptor_atomic_cas_ptr((void *volatile *)&receptor_pool_abandoned, (void **)&top, a));
+	}
+
+	cache->arenas = NULL;
+}
+
+#else
+
+void
+receptor_pool_arena_thread_done(void)
+{
+}
+
+#endif
@@ -3,18 +3,139 @@
 
 #include <receptor/def.h>
 
+#ifdef RECEPTOR_DEBUG_ALLOC
+#include <stdio.h>
+#endif
+
+#define RECEPTOR_DEFAULT_POOL_SIZE    (16 * 1024)
+
 typedef struct receptor_pool_s     receptor_pool_t;
+typedef struct receptor_pool_large_s  receptor_pool_large_t;
+typedef struct receptor_pool_cleanup_s  receptor_pool_cleanup_t;
+
+typedef void(*receptor_pool_cleanup_pt)(void *data);
+
+/* 销毁池时按注册的相反顺序调用，handler 为 NULL 的节点跳过 */
+struct receptor_pool_cleanup_s {
+	receptor_pool_cleanup_pt    handler;
+	void                       *data;
+	receptor_pool_cleanup_t    *next;
+};
+
+/* receptor_pool_cleanup_file / receptor_pool_delete_file 的参数 */
+typedef struct {
+	int                         fd;
+	const char                 *name;
+} receptor_pool_cleanup_file_t;
+
+/* receptor_pool_cleanup_mmap 的参数 */
+typedef struct {
+	void                       *addr;
+	size_t                      size;
+} receptor_pool_cleanup_mmap_t;
+
+/* 超过块大小的分配单独向系统申请，挂在池上随池释放 */
+struct receptor_pool_large_s {
+	receptor_pool_large_t   *next;
+	void                    *alloc;     /* 已提前释放时为 NULL，节点可复用 */
+#ifdef RECEPTOR_DEBUG_ALLOC
+	size_t                  size;
+#endif
+};
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+/*
+ * 分配统计，用来按负载确定池的块大小。单个池只在一个线程上使用，
+ * 全局统计以原子加累计，peak 在并发下是近似值。
+ * tail 对单个池是各块末尾当前空着的字节数，对全局是已销毁或重置的池
+ * 留下的总和。
+ */
+typedef struct {
+	uint64_t                pools;      /* 仅全局：存活的池数 */
+	uint64_t                requested;  /* 调用方请求的字节数 */
+	uint64_t                align;      /* 对齐填充的字节数 */
+	uint64_t                tail;       /* 块末尾放不下新分配而空着的字节数 */
+	uint64_t                blocks;     /* 向系统申请的块数，含第一块 */
+	uint64_t                large;      /* 大块分配次数 */
+	uint64_t                size;       /* 当前占用：块加上存活的大块 */
+	uint64_t                peak;       /* size 的峰值 */
+} receptor_pool_stats_t;
+#endif
 
+/*
+ * 内存池由若干块串成链表，第一块同时保存池的状态。
+ * 某块连续多次放不下新的分配后 current 跳过它，分配不必从头遍历。
+ */
 struct receptor_pool_s {
 	char                *last;
 	char                *end;
 	receptor_pool_t     *next;
-	receptor_uint_t     failed;
+	receptor_uint_t     failed;     /* 本块放不下分配的次数 */
+	receptor_pool_t     *current;   /* 第一块有效，分配从这里开始查找 */
+	receptor_pool_large_t *large;   /* 第一块有效 */
+	receptor_pool_cleanup_t *cleanup;  /* 第一块有效，后注册的在前 */
+	receptor_uint_t     arena;      /* 第一块有效，块来自大页区域 */
+	size_t              block;      /* 第一块有效，下一个新块的大小 */
+	size_t              block_max;  /* 第一块有效，几何增长的上限，0 表示不增长 */
+	size_t              max;        /* 第一块有效，不超过它的分配从块中切出 */
+#ifdef RECEPTOR_DEBUG_ALLOC
+	receptor_pool_stats_t stats;    /* 第一块有效 */
+#endif
 };
 
+/*
+ * size 同时是之后每个新块的大小 (不小于 1024)，不超过块中可用空间的
+ * 分配从块中切出，更大的单独向系统申请。
+ */
 receptor_pool_t *receptor_create_pool(size_t size);
+
+/*
+ * 开启几何增长：之后每个新块是上一个的两倍，直到 max；
+ * max 不大于当前块大小时关闭。小分配的上限仍按第一块计算。
+ * 对 receptor_create_pool_arena 创建的池无效。
+ */
+void receptor_pool_set_growth(receptor_pool_t *pool, size_t max);
 void receptor_destroy_pool(receptor_pool_t *pool);
+
+/*
+ * 块取自调用线程的大页区域 (Linux：2MB 对齐、MADV_HUGEPAGE、
+ * 优先绑定到线程所在的 NUMA 节点)，块大小固定为 RECEPTOR_DEFAULT_POOL_SIZE。
+ * 池可以在任意线程销毁，块回到所属区域。其它平台等同于 receptor_create_pool。
+ */
+receptor_pool_t *receptor_create_pool_arena(void);
+/* 把本线程的区域交给其它线程接管；使用过区域的线程退出时自动调用，也可以提前调用 */
+void receptor_pool_arena_thread_done(void);
+/*
+ * 运行清理函数、释放大块分配，各块回绕到空状态后保留，
+ * 用于长连接上逐个请求复用同一个池。
+ */
+void receptor_reset_pool(receptor_pool_t *pool);
 void *receptor_palloc(receptor_pool_t *pool, size_t size);
 void *receptor_pcalloc(receptor_pool_t *pool, size_t size);
+/* 不对齐的分配，用于字符串等按字节访问的数据 */
+void *receptor_pnalloc(receptor_pool_t *pool, size_t size);
+/* 提前释放一块大内存分配，p 不是大块分配时返回 RECEPTOR_ERROR */
+receptor_int_t receptor_pfree(receptor_pool_t *pool, void *p);
+
+/*
+ * 注册一个清理节点，size 非零时同时从池中分配 size 字节作为 data，
+ * 调用方填写 handler 和 data 的内容。失败返回 NULL。
+ */
+receptor_pool_cleanup_t *receptor_pool_cleanup_add(receptor_pool_t *pool, size_t size);
+
+/* 提前关闭池上登记的描述符 fd，对应的清理节点随之失效 */
+void receptor_pool_run_cleanup_file(receptor_pool_t *pool, int fd);
+
+/* 常用的清理函数，data 分别为 receptor_pool_cleanup_file_t 和 receptor_pool_cleanup_mmap_t */
+void receptor_pool_cleanup_file(void *data);
+void receptor_pool_delete_file(void *data);
+void receptor_pool_cleanup_mmap(void *data);
+
+#ifdef RECEPTOR_DEBUG_ALLOC
+/* pool 为 NULL 时取全局统计 */
+void receptor_pool_get_stats(receptor_pool_t *pool, receptor_pool_stats_t *stats);
+/* 以一行文本写出统计，pool 为 NULL 时写全局统计 */
+void receptor_pool_dump(receptor_pool_t *pool, FILE *fp);
+#endif
 
 #endif /* _RECEPTOR_PALLOC_H_ */
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef _RECEPTOR_QUEUE_H_
+#define _RECEPTOR_QUEUE_H_
+
+#include "receptor/def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 侵入式双向队列 ==================== */
+
+	/**
+	 * 队列节点嵌入到宿主结构中，插入和删除都是 O(1)，不分配内存。
+	 * 仿照nginx的 ngx_queue_t，头节点作为哨兵。
+	 */
+	typedef struct receptor_queue_s receptor_queue_t;
+
+	struct receptor_queue_s {
+		receptor_queue_t       *prev;
+		receptor_queue_t       *next;
+	};
+
+#define receptor_queue_init(q)                                                \
+    (q)->prev = q;                                                            \
+    (q)->next = q
+
+#define receptor_queue_empty(h)                                               \
+    ((h) == (h)->prev)
+
+#define receptor_queue_insert_head(h, x)                                      \
+    (x)->next = (h)->next;                                                    \
+    (x)->next->prev = x;                                                      \
+    (x)->prev = h;                                                            \
+    (h)->next = x
+
+#define receptor_queue_insert_tail(h, x)                                      \
+    (x)->prev = (h)->prev;                                                    \
+    (x)->prev->next = x;                                                      \
+    (x)->next = h;                                                            \
+    (h)->prev = x
+
+#define receptor_queue_head(h)                                                \
+    (h)->next
+
+#define receptor_queue_last(h)                                                \
+    (h)->prev
+
+#define receptor_queue_sentinel(h)                                            \
+    (h)
+
+#define receptor_queue_next(q)                                                \
+    (q)->next
+
+#define receptor_queue_prev(q)                                                \
+    (q)->prev
+
+#define receptor_queue_remove(x)                                              \
+    (x)->next->prev = (x)->prev;                                              \
+    (x)->prev->next = (x)->next
+
+	/* 由队列节点取得宿主结构 */
+#define receptor_queue_data(q, type, link)                                    \
+    ((type *) ((char *) (q) - offsetof(type, link)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_QUEUE_H_ */
@@ -0,0 +1,98 @@
+#include <receptor/def.h>
+#include "receptor_shm.h"
+#include "receptor_atomic.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+/* 自旋这么多次仍未拿到锁时让出 CPU */
+#define RECEPTOR_SHMTX_SPIN      2048
+
+RECEPTOR_API receptor_int_t
+receptor_shm_alloc(receptor_shm_t *shm)
+{
+#ifdef _WIN32
+	shm->handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		(DWORD)((uint64_t)shm->size >> 32), (DWORD)(shm->size & 0xffffffff),
+		(const char *)shm->name.data);
+	if (shm->handle == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	shm->addr = MapViewOfFile(shm->handle, FILE_MAP_WRITE, 0, 0, 0);
+	if (shm->addr == NULL) {
+		CloseHandle(shm->handle);
+		return RECEPTOR_ERROR;
+	}
+#else
+	shm->addr = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
+	if (shm->addr == MAP_FAILED) {
+		shm->addr = NULL;
+		return RECEPTOR_ERROR;
+	}
+#endif
+
+	return RECEPTOR_OK;
+}
+
+RECEPTOR_API void
+receptor_shm_free(receptor_shm_t *shm)
+{
+	if (shm->addr == NULL) {
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(shm->addr);
+	CloseHandle(shm->handle);
+#else
+	munmap(shm->addr, shm->size);
+#endif
+
+	shm->addr = NULL;
+}
+
+/* 锁字为 NULL 表示空闲；exchange 同时带获取和释放语义 */
+RECEPTOR_API receptor_int_t
+receptor_shmtx_trylock(receptor_shmtx_t *mtx)
+{
+	if (receptor_atomic_load_ptr(&mtx->lock) != NULL) {
+		return 0;
+	}
+
+	return receptor_atomic_exchange_ptr(&mtx->lock, (void *)1) == NULL;
+}
+
+RECEPTOR_API void
+receptor_shmtx_lock(receptor_shmtx_t *mtx)
+{
+	receptor_uint_t n;
+
+	for ( ;; ) {
+		if (receptor_shmtx_trylock(mtx)) {
+			return;
+		}
+
+		for (n = 0; n < RECEPTOR_SHMTX_SPIN; n++) {
+			if (receptor_atomic_load_ptr(&mtx->lock) == NULL) {
+				break;
+			}
+		}
+
+		if (n == RECEPTOR_SHMTX_SPIN) {
+#ifdef _WIN32
+			SwitchToThread();
+#else
+			sched_yield();
+#endif
+		}
+	}
+}
+
+RECEPTOR_API void
+receptor_shmtx_unlock(receptor_shmtx_t *mtx)
+{
+	(void)receptor_atomic_exchange_ptr(&mtx->lock, NULL);
+}
@@ -0,0 +1,92 @@
+#ifndef _RECEPTOR_SHM_H_
+#define _RECEPTOR_SHM_H_
+
+#include "receptor/def.h"
+#include "receptor_string.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 共享内存 ==================== */
+
+	/**
+	 * 匿名共享映射 (Unix 上 MAP_SHARED | MAP_ANONYMOUS，Windows 上以 name 命名的
+	 * 文件映射)。Unix 上工作进程经 fork 继承映射，各进程中地址相同，
+	 * 区域内可以直接保存指针。
+	 */
+	typedef struct {
+		u_char                 *addr;
+		size_t                  size;
+		receptor_str_t          name;      /* 以 '\0' 结尾 */
+#ifdef _WIN32
+		HANDLE                  handle;
+#endif
+		receptor_uint_t         exists;    /* 沿用了重载前的映射 */
+	} receptor_shm_t;
+
+	/**
+	 * 进程间自旋锁，放在共享内存中。先自旋再让出 CPU，
+	 * 持锁的进程异常退出时锁不会释放，临界区内不要做可能失败的事情。
+	 */
+	typedef struct {
+		void *volatile          lock;
+	} receptor_shmtx_t;
+
+	/* ==================== 共享内存区 ==================== */
+
+	typedef struct receptor_shm_zone_s receptor_shm_zone_t;
+
+	/**
+	 * 区创建或重载后调用。data 为重载前同一个区的 zone->data，
+	 * 新建时为 NULL；沿用时共享内存中的内容保持不变。
+	 */
+	typedef receptor_int_t(*receptor_shm_zone_init_pt)(receptor_shm_zone_t *zone, void *data);
+
+	/**
+	 * 命名共享内存区，由 receptor_shared_memory_add 登记，receptor_start 时创建。
+	 * 内存开头是 receptor_shm_pool_t，之后的空间由它按 slab 方式分配。
+	 * 重载时名称、大小和 tag 都相同的区沿用原有映射。
+	 */
+	struct receptor_shm_zone_s {
+		void                       *data;   /* 由 init 设置，通常指向区内的根结构 */
+		receptor_shm_t              shm;
+		receptor_shm_zone_init_pt   init;
+		void                       *tag;    /* 登记者的标识，通常为模块地址 */
+		receptor_uint_t             noreuse;    /* 重载时总是新建 */
+	};
+
+	/* 共享内存区不小于这么多页 */
+#define RECEPTOR_SHM_MIN_PAGES   8
+
+	/* ==================== 共享内存API ==================== */
+
+	/**
+	 * @brief 创建映射，size 和 name 由调用方设置
+	 * @param shm 共享内存
+	 * @return RECEPTOR_OK 成功, RECEPTOR_ERROR 失败
+	 */
+	RECEPTOR_API receptor_int_t
+		receptor_shm_alloc(receptor_shm_t *shm);
+
+	/**
+	 * @brief 解除映射
+	 * @param shm 共享内存
+	 */
+	RECEPTOR_API void
+		receptor_shm_free(receptor_shm_t *shm);
+
+	RECEPTOR_API void
+		receptor_shmtx_lock(receptor_shmtx_t *mtx);
+
+	RECEPTOR_API receptor_int_t
+		receptor_shmtx_trylock(receptor_shmtx_t *mtx);
+
+	RECEPTOR_API void
+		receptor_shmtx_unlock(receptor_shmtx_t *mtx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_SHM_H_ */
@@ -0,0 +1,321 @@
+#include <receptor/def.h>
+#include "receptor_shm_slab.h"
+#include <string.h>
+
+#define RECEPTOR_SHM_PAGE_FREE   0
+#define RECEPTOR_SHM_PAGE_SMALL  1
+#define RECEPTOR_SHM_PAGE_RUN    2      /* 整页分配的首页 */
+#define RECEPTOR_SHM_PAGE_BUSY   3      /* 整页分配的后续页 */
+
+#define RECEPTOR_SHM_MAX_SMALL   (RECEPTOR_SHM_PAGE_SIZE / 2)
+
+#define receptor_shm_page_addr(pool, page)                                    \
+    ((pool)->start + (((uintptr_t) ((page) - (pool)->pages)) << RECEPTOR_SHM_PAGE_SHIFT))
+
+#define receptor_shm_page_of(pool, p)                                         \
+    ((pool)->pages + (((u_char *) (p) - (pool)->start) >> RECEPTOR_SHM_PAGE_SHIFT))
+
+/* ==================== 双向链表 ==================== */
+
+static void
+receptor_shm_list_init(receptor_shm_page_t *h)
+{
+	h->next = h;
+	h->prev = h;
+}
+
+static void
+receptor_shm_list_insert(receptor_shm_page_t *h, receptor_shm_page_t *page)
+{
+	page->next = h->next;
+	page->prev = h;
+	h->next->prev = page;
+	h->next = page;
+}
+
+/* 移出后 next 置为 NULL，表示不在链表上 */
+static void
+receptor_shm_list_remove(receptor_shm_page_t *page)
+{
+	page->prev->next = page->next;
+	page->next->prev = page->prev;
+	page->next = NULL;
+	page->prev = NULL;
+}
+
+/* ==================== 页分配 ==================== */
+
+static void
+receptor_shm_mark_free(receptor_shm_pool_t *pool, receptor_shm_page_t *page, receptor_uint_t n)
+{
+	receptor_shm_page_t *tail;
+
+	page->type = RECEPTOR_SHM_PAGE_FREE;
+	page->npages = (uint32_t)n;
+	receptor_shm_list_insert(&pool->free, page);
+
+	if (n > 1) {
+		tail = page + n - 1;
+		tail->type = RECEPTOR_SHM_PAGE_FREE;
+		tail->npages = 0;
+		tail->next = NULL;
+		tail->prev = page;
+	}
+}
+
+/* 首次适配，调用方持有 pool->mutex */
+static receptor_shm_page_t *
+receptor_shm_alloc_pages(receptor_shm_pool_t *pool, receptor_uint_t n)
+{
+	receptor_uint_t          i;
+	receptor_shm_page_t     *page;
+
+	for (page = pool->free.next; page != &pool->free; page = page->next) {
+
+		if (page->npages < n) {
+			continue;
+		}
+
+		receptor_shm_list_remove(page);
+
+		if (page->npages > n) {
+			receptor_shm_mark_free(pool, page + n, page->npages - n);
+		}
+
+		page->type = RECEPTOR_SHM_PAGE_RUN;
+		page->npages = (uint32_t)n;
+
+		for (i = 1; i < n; i++) {
+			page[i].type = RECEPTOR_SHM_PAGE_BUSY;
+		}
+
+		pool->pfree -= n;
+
+		return page;
+	}
+
+	return NULL;
+}
+
+/* 与前后相邻的空闲段合并，调用方持有 pool->mutex */
+static void
+receptor_shm_free_pages(receptor_shm_pool_t *pool, receptor_shm_page_t *page, receptor_uint_t n)
+{
+	receptor_shm_page_t *next, *prev;
+
+	pool->pfree += n;
+
+	next = page + n;
+
+	if (next < pool->last && next->type == RECEPTOR_SHM_PAGE_FREE && next->npages) {
+		receptor_shm_list_remove(next);
+		n += next->npages;
+	}
+
+	if (page > pool->pages) {
+		prev = page - 1;
+
+		if (prev->type == RECEPTOR_SHM_PAGE_FREE) {
+			if (prev->npages == 0) {
+				prev = prev->prev;
+			}
+
+			receptor_shm_list_remove(prev);
+			n += prev->npages;
+			page = prev;
+		}
+	}
+
+	receptor_shm_mark_free(pool, page, n);
+}
+
+/* ==================== slab 实现 ==================== */
+
+RECEPTOR_API receptor_shm_pool_t*
+receptor_shm_slab_init(void *addr, size_t size)
+{
+	u_char                  *p, *end;
+	receptor_uint_t          i, n;
+	receptor_shm_pool_t     *pool;
+
+	if (size < sizeof(receptor_shm_pool_t) + RECEPTOR_SHM_PAGE_SIZE + sizeof(receptor_shm_page_t)) {
+		return NULL;
+	}
+
+	pool = addr;
+	memset(pool, 0, sizeof(receptor_shm_pool_t));
+
+	p = (u_char *)addr + sizeof(receptor_shm_pool_t);
+	end = (u_char *)addr + size;
+
+	/* 描述符数组之后按页对齐，放不下时减少一页 */
+	n = (size - sizeof(receptor_shm_pool_t)) / (RECEPTOR_SHM_PAGE_SIZE + sizeof(receptor_shm_page_t));
+
+	for ( ;; ) {
+		pool->start = (u_char *)(((uintptr_t)(p + n * sizeof(receptor_shm_page_t))
+			+ RECEPTOR_SHM_PAGE_SIZE - 1) & ~((uintptr_t)RECEPTOR_SHM_PAGE_SIZE - 1));
+
+		if (pool->start + n * RECEPTOR_SHM_PAGE_SIZE <= end || n == 0) {
+			break;
+		}
+
+		n--;
+	}
+
+	if (n == 0) {
+		return NULL;
+	}
+
+	pool->pages = (receptor_shm_page_t *)p;
+	pool->last = pool->pages + n;
+	pool->end = pool->start + n * RECEPTOR_SHM_PAGE_SIZE;
+	pool->pfree = n;
+
+	memset(pool->pages, 0, n * sizeof(receptor_shm_page_t));
+
+	receptor_shm_list_init(&pool->free);
+
+	for (i = 0; i < RECEPTOR_SHM_CLASSES; i++) {
+		receptor_shm_list_init(&pool->classes[i].partial);
+	}
+
+	receptor_shm_mark_free(pool, pool->pages, n);
+
+	return pool;
+}
+
+static void *
+receptor_shm_slab_alloc_small(receptor_shm_pool_t *pool, size_t size)
+{
+	u_char                  *obj;
+	receptor_uint_t          slot, shift;
+	receptor_shm_page_t     *page;
+	receptor_shm_class_t    *cls;
+
+	for (shift = RECEPTOR_SHM_MIN_SHIFT; ((size_t)1 << shift) < size; shift++) {
+		/* void */
+	}
+
+	slot = shift - RECEPTOR_SHM_MIN_SHIFT;
+	cls = &pool->classes[slot];
+
+	receptor_shmtx_lock(&cls->mutex);
+
+	cls->reqs++;
+
+	page = cls->partial.next;
+
+	if (page == &cls->partial) {
+		receptor_shmtx_lock(&pool->mutex);
+		page = receptor_shm_alloc_pages(pool, 1);
+		receptor_shmtx_unlock(&pool->mutex);
+
+		if (page == NULL) {
+			cls->fails++;
+			receptor_shmtx_unlock(&cls->mutex);
+			return NULL;
+		}
+
+		page->type = RECEPTOR_SHM_PAGE_SMALL;
+		page->slot = (uint32_t)slot;
+		page->used = 0;
+		page->carved = 0;
+		page->free = NULL;
+
+		receptor_shm_list_insert(&cls->partial, page);
+	}
+
+	if (page->free) {
+		obj = page->free;
+		page->free = *(void **)obj;
+	}
+	else {
+		obj = receptor_shm_page_addr(pool, page) + ((size_t)page->carved << shift);
+		page->carved++;
+	}
+
+	/* 页已满，移出 partial */
+	if (++page->used == (uint32_t)(RECEPTOR_SHM_PAGE_SIZE >> shift)) {
+		receptor_shm_list_remove(page);
+	}
+
+	receptor_shmtx_unlock(&cls->mutex);
+
+	return obj;
+}
+
+RECEPTOR_API void*
+receptor_shm_slab_alloc(receptor_shm_pool_t *pool, size_t size)
+{
+	receptor_shm_page_t *page;
+
+	if (size <= RECEPTOR_SHM_MAX_SMALL) {
+		return receptor_shm_slab_alloc_small(pool, size);
+	}
+
+	receptor_shmtx_lock(&pool->mutex);
+	page = receptor_shm_alloc_pages(pool,
+		(size + RECEPTOR_SHM_PAGE_SIZE - 1) >> RECEPTOR_SHM_PAGE_SHIFT);
+	receptor_shmtx_unlock(&pool->mutex);
+
+	return page ? receptor_shm_page_addr(pool, page) : NULL;
+}
+
+RECEPTOR_API void*
+receptor_shm_slab_calloc(receptor_shm_pool_t *pool, size_t size)
+{
+	void *p;
+
+	p = receptor_shm_slab_alloc(pool, size);
+	if (p) {
+		memset(p, 0, size);
+	}
+
+	return p;
+}
+
+RECEPTOR_API void
+receptor_shm_slab_free(receptor_shm_pool_t *pool, void *p)
+{
+	receptor_shm_page_t     *page;
+	receptor_shm_class_t    *cls;
+
+	if ((u_char *)p < pool->start || (u_char *)p >= pool->end) {
+		return;
+	}
+
+	page = receptor_shm_page_of(pool, p);
+
+	if (page->type == RECEPTOR_SHM_PAGE_RUN) {
+		receptor_shmtx_lock(&pool->mutex);
+		receptor_shm_free_pages(pool, page, page->npages);
+		receptor_shmtx_unlock(&pool->mutex);
+		return;
+	}
+
+	if (page->type != RECEPTOR_SHM_PAGE_SMALL) {
+		return;
+	}
+
+	cls = &pool->classes[page->slot];
+
+	receptor_shmtx_lock(&cls->mutex);
+
+	*(void **)p = page->free;
+	page->free = p;
+
+	/* 满页重新有了空闲对象 */
+	if (page->next == NULL) {
+		receptor_shm_list_insert(&cls->partial, page);
+	}
+
+	if (--page->used == 0) {
+		receptor_shm_list_remove(page);
+
+		receptor_shmtx_lock(&pool->mutex);
+		receptor_shm_free_pages(pool, page, 1);
+		receptor_shmtx_unlock(&pool->mutex);
+	}
+
+	receptor_shmtx_unlock(&cls->mutex);
+}
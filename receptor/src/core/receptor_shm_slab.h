@@ -0,0 +1,92 @@
+#ifndef _RECEPTOR_SHM_SLAB_H_
+#define _RECEPTOR_SHM_SLAB_H_
+
+#include "receptor/def.h"
+#include "receptor_shm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 共享内存 slab 分配器 ==================== */
+
+	/**
+	 * 管理一块共享内存，结构本身放在内存开头。内存按页切分：
+	 * 不超过半页的分配按 2 的幂取整，同一大小类的对象放在同一页中；
+	 * 更大的分配占用连续的整页，释放时与相邻的空闲页合并。
+	 * 每个大小类一把锁，页的分配与释放另用一把锁，加锁顺序总是先类后页。
+	 */
+#define RECEPTOR_SHM_PAGE_SHIFT  12
+#define RECEPTOR_SHM_PAGE_SIZE   (1 << RECEPTOR_SHM_PAGE_SHIFT)
+#define RECEPTOR_SHM_MIN_SHIFT   4
+#define RECEPTOR_SHM_CLASSES     (RECEPTOR_SHM_PAGE_SHIFT - RECEPTOR_SHM_MIN_SHIFT)
+
+	typedef struct receptor_shm_page_s receptor_shm_page_t;
+
+	/* 页描述符，与页一一对应 */
+	struct receptor_shm_page_s {
+		receptor_shm_page_t    *next;
+		receptor_shm_page_t    *prev;      /* 空闲段的尾页指向段首 */
+		void                   *free;      /* 小对象页的空闲链表 */
+		uint32_t                type;
+		uint32_t                slot;      /* 小对象页的大小类 */
+		uint32_t                used;      /* 小对象页已分配的对象数 */
+		uint32_t                carved;    /* 小对象页已切出的对象数，按需切分 */
+		uint32_t                npages;    /* 空闲段或整页分配的页数，只在首页有效 */
+	};
+
+	typedef struct {
+		receptor_shmtx_t        mutex;
+		receptor_shm_page_t     partial;   /* 尚有空闲对象的页，哨兵 */
+		uint64_t                reqs;
+		uint64_t                fails;
+	} receptor_shm_class_t;
+
+	typedef struct {
+		receptor_shmtx_t        mutex;     /* 保护 free 链表和 pfree */
+		receptor_shm_page_t     free;      /* 空闲页段，哨兵 */
+		receptor_shm_class_t    classes[RECEPTOR_SHM_CLASSES];
+		receptor_shm_page_t    *pages;
+		receptor_shm_page_t    *last;
+		u_char                 *start;     /* 第一页，按页对齐 */
+		u_char                 *end;
+		receptor_uint_t         pfree;     /* 空闲页数 */
+		void                   *data;      /* 使用者的根结构 */
+	} receptor_shm_pool_t;
+
+	/* ==================== slab API ==================== */
+
+	/**
+	 * @brief 在 size 字节的共享内存上建立分配器，新建共享内存区时自动调用
+	 * @param addr 内存起始地址，按页对齐
+	 * @param size 内存大小
+	 * @return 分配器，内存不足一页时返回 NULL
+	 */
+	RECEPTOR_API receptor_shm_pool_t*
+		receptor_shm_slab_init(void *addr, size_t size);
+
+	/**
+	 * @brief 分配共享内存，不超过半页时 16 字节对齐，否则按页对齐
+	 * @param pool 分配器
+	 * @param size 大小
+	 * @return 内存不足时返回 NULL
+	 */
+	RECEPTOR_API void*
+		receptor_shm_slab_alloc(receptor_shm_pool_t *pool, size_t size);
+
+	RECEPTOR_API void*
+		receptor_shm_slab_calloc(receptor_shm_pool_t *pool, size_t size);
+
+	/**
+	 * @brief 释放，可以在任意进程调用
+	 * @param pool 分配器
+	 * @param p 分配得到的指针，不属于该分配器时忽略
+	 */
+	RECEPTOR_API void
+		receptor_shm_slab_free(receptor_shm_pool_t *pool, void *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_SHM_SLAB_H_ */
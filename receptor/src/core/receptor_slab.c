@@ -0,0 +1,548 @@
+#include <receptor/def.h>
+#include "receptor_slab.h"
+#include "receptor_palloc.h"
+#include "receptor_atomic.h"
+#include "receptor_queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#endif
+
+#define RECEPTOR_SLAB_ALIGNMENT      16
+
+/* 128 以内每 16 字节一类，之后每个 2 的幂区间分 4 类，到 1024 共 20 类 */
+#define RECEPTOR_SLAB_CLASSES        20
+
+#if defined(_MSC_VER)
+#define RECEPTOR_SLAB_THREAD_LOCAL   __declspec(thread)
+#else
+#define RECEPTOR_SLAB_THREAD_LOCAL   __thread
+#endif
+
+#define receptor_slab_page_of(p)                                              \
+    ((receptor_slab_page_t *) ((uintptr_t) (p) & ~((uintptr_t) RECEPTOR_SLAB_PAGE_SIZE - 1)))
+
+typedef struct receptor_slab_page_s   receptor_slab_page_t;
+typedef struct receptor_slab_cache_s  receptor_slab_cache_t;
+
+/* 空闲对象的前 8 字节用作链接 */
+typedef struct receptor_slab_obj_s    receptor_slab_obj_t;
+
+struct receptor_slab_obj_s {
+	receptor_slab_obj_t        *next;
+};
+
+/*
+ * 页头位于页的起始处。used 只由所有者修改，远程释放的对象
+ * 在所有者取回时才从 used 中扣除。
+ */
+struct receptor_slab_page_s {
+	receptor_slab_cache_t      *owner;     /* 交出后为 NULL */
+	receptor_slab_obj_t        *free;      /* 所有者的空闲链表 */
+	char                       *last;      /* 尚未切分的区域，按需切分避免一次触碰整页 */
+	char                       *end;
+	receptor_uint_t             used;
+	receptor_uint_t             size;
+	receptor_uint_t             slot;      /* 大小类下标 */
+	receptor_uint_t             full;      /* 在 full 链表上 */
+	receptor_queue_t            queue;
+	receptor_slab_page_t       *abandoned;
+
+	/* 其它线程释放的对象，单独占一个缓存行，避免与所有者的字段伪共享 */
+	RECEPTOR_CACHELINE_ALIGNED receptor_slab_obj_t *volatile remote;
+};
+
+typedef struct {
+	receptor_slab_page_t       *current;   /* 正在分配的页，不在任何链表上 */
+	receptor_queue_t            partial;   /* 空闲链表非空的页 */
+	receptor_queue_t            full;      /* 空闲链表已空的页，可能有待取回的远程释放 */
+} receptor_slab_class_t;
+
+struct receptor_slab_cache_s {
+	receptor_slab_class_t       classes[RECEPTOR_SLAB_CLASSES];
+	receptor_uint_t             inited;
+};
+
+static RECEPTOR_SLAB_THREAD_LOCAL receptor_slab_cache_t  receptor_slab_cache;
+
+/* 线程退出时交出的页，以 abandoned 串成后进先出栈 */
+static receptor_slab_page_t *volatile  receptor_slab_abandoned;
+
+/* 线程退出回调的键，创建失败时只能由线程自己调用各 thread_done */
+#ifdef _WIN32
+static INIT_ONCE        receptor_slab_once = INIT_ONCE_STATIC_INIT;
+static DWORD            receptor_slab_key = FLS_OUT_OF_INDEXES;
+#else
+static pthread_once_t   receptor_slab_once = PTHREAD_ONCE_INIT;
+static pthread_key_t    receptor_slab_key;
+static receptor_uint_t  receptor_slab_key_ok;
+#endif
+
+static receptor_uint_t
+receptor_slab_slot(size_t size)
+{
+	receptor_uint_t n, b;
+
+	if (size <= 128) {
+		return (size == 0) ? 0 : (receptor_uint_t)((size + 15) >> 4) - 1;
+	}
+
+	n = (receptor_uint_t)size - 1;
+
+	for (b = 7; (n >> (b + 1)) != 0; b++) {
+		/* void */
+	}
+
+	return 8 + (b - 7) * 4 + ((n >> (b - 2)) & 3);
+}
+
+static size_t
+receptor_slab_slot_size(receptor_uint_t slot)
+{
+	size_t base;
+
+	if (slot < 8) {
+		return (slot + 1) * 16;
+	}
+
+	base = (size_t)128 << ((slot - 8) / 4);
+
+	return base + ((slot - 8) % 4 + 1) * (base / 4);
+}
+
+static void *
+receptor_slab_page_alloc(void)
+{
+	void *p;
+
+#ifdef _WIN32
+	p = _aligned_malloc(RECEPTOR_SLAB_PAGE_SIZE, RECEPTOR_SLAB_PAGE_SIZE);
+#else
+	if (posix_memalign(&p, RECEPTOR_SLAB_PAGE_SIZE, RECEPTOR_SLAB_PAGE_SIZE) != 0) {
+		return NULL;
+	}
+#endif
+
+	return p;
+}
+
+static void
+receptor_slab_page_free(receptor_slab_page_t *page)
+{
+#ifdef _WIN32
+	_aligned_free(page);
+#else
+	free(page);
+#endif
+}
+
+/* ==================== 线程退出回调 ==================== */
+
+/*
+ * 线程不调用 thread_done 就退出时，它的 slab 页和池块区域仍以已失效的
+ * 线程本地缓存为所有者。线程第一次使用 slab 或池块区域时在键上设置
+ * 非空值，退出时由 pthread 键析构函数 (Windows 上为 FLS 回调) 一并交出。
+ */
+#ifdef _WIN32
+
+static VOID WINAPI
+receptor_slab_thread_exit(PVOID data)
+{
+	(void)data;
+	receptor_slab_thread_done();
+	receptor_pool_arena_thread_done();
+}
+
+static BOOL CALLBACK
+receptor_slab_key_init(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+	(void)once;
+	(void)param;
+	(void)context;
+
+	receptor_slab_key = FlsAlloc(receptor_slab_thread_exit);
+	return TRUE;
+}
+
+#else
+
+static void
+receptor_slab_thread_exit(void *data)
+{
+	(void)data;
+	receptor_slab_thread_done();
+	receptor_pool_arena_thread_done();
+}
+
+static void
+receptor_slab_key_init(void)
+{
+	receptor_slab_key_ok = (pthread_key_create(&receptor_slab_key, receptor_slab_thread_exit) == 0);
+}
+
+#endif
+
+RECEPTOR_API void
+receptor_slab_thread_register(void)
+{
+#ifdef _WIN32
+	(void)InitOnceExecuteOnce(&receptor_slab_once, receptor_slab_key_init, NULL, NULL);
+
+	if (receptor_slab_key != FLS_OUT_OF_INDEXES) {
+		(void)FlsSetValue(receptor_slab_key, &receptor_slab_cache);
+	}
+#else
+	(void)pthread_once(&receptor_slab_once, receptor_slab_key_init);
+
+	if (receptor_slab_key_ok) {
+		(void)pthread_setspecific(receptor_slab_key, &receptor_slab_cache);
+	}
+#endif
+}
+
+static void
+receptor_slab_cache_init(receptor_slab_cache_t *cache)
+{
+	receptor_uint_t i;
+
+	for (i = 0; i < RECEPTOR_SLAB_CLASSES; i++) {
+		cache->classes[i].current = NULL;
+		receptor_queue_init(&cache->classes[i].partial);
+		receptor_queue_init(&cache->classes[i].full);
+	}
+
+	cache->inited = 1;
+
+	receptor_slab_thread_register();
+}
+
+/* 取回其它线程释放的对象，返回取回的个数 */
+static receptor_uint_t
+receptor_slab_collect(receptor_slab_page_t *page)
+{
+	receptor_uint_t         n;
+	receptor_slab_obj_t    *head, *obj;
+
+	if (receptor_atomic_load_ptr(&page->remote) == NULL) {
+		return 0;
+	}
+
+	head = receptor_atomic_exchange_ptr(&page->remote, NULL);
+	if (head == NULL) {
+		return 0;
+	}
+
+	n = 1;
+
+	for (obj = head; obj->next; obj = obj->next) {
+		n++;
+	}
+
+	obj->next = page->free;
+	page->free = head;
+	page->used -= n;
+
+	return n;
+}
+
+static receptor_slab_page_t *
+receptor_slab_page_create(receptor_slab_cache_t *cache, receptor_uint_t slot)
+{
+	receptor_slab_page_t *page;
+
+	page = receptor_slab_page_alloc();
+	if (page == NULL) {
+		return NULL;
+	}
+
+	page->owner = cache;
+	page->free = NULL;
+	page->last = (char *)page
+		+ ((sizeof(receptor_slab_page_t) + RECEPTOR_SLAB_ALIGNMENT - 1) & ~(RECEPTOR_SLAB_ALIGNMENT - 1));
+	page->end = (char *)page + RECEPTOR_SLAB_PAGE_SIZE;
+	page->used = 0;
+	page->size = receptor_slab_slot_size(slot);
+	page->slot = slot;
+	page->full = 0;
+	page->abandoned = NULL;
+	page->remote = NULL;
+
+	return page;
+}
+
+/* 把 page 放进所有者对应大小类的 partial 或 full 链表，空页直接释放 */
+static void
+receptor_slab_page_file(receptor_slab_cache_t *cache, receptor_slab_page_t *page)
+{
+	receptor_slab_class_t *cls = &cache->classes[page->slot];
+
+	if (page->used == 0) {
+		receptor_slab_page_free(page);
+		return;
+	}
+
+	if (page->free || page->last + page->size <= page->end) {
+		page->full = 0;
+		receptor_queue_insert_tail(&cls->partial, &page->queue);
+	}
+	else {
+		page->full = 1;
+		receptor_queue_insert_tail(&cls->full, &page->queue);
+	}
+}
+
+/* 接管其它线程退出时交出的全部页 */
+static void
+receptor_slab_adopt(receptor_slab_cache_t *cache)
+{
+	receptor_slab_page_t *page, *next;
+
+	if (receptor_atomic_load_ptr(&receptor_slab_abandoned) == NULL) {
+		return;
+	}
+
+	page = receptor_atomic_exchange_ptr(&receptor_slab_abandoned, NULL);
+
+	for ( /* void */; page; page = next) {
+		next = page->abandoned;
+		page->abandoned = NULL;
+
+		(void)receptor_atomic_exchange_ptr(&page->owner, cache);
+		receptor_slab_collect(page);
+		receptor_slab_page_file(cache, page);
+	}
+}
+
+/*
+ * current 用完时调用：依次尝试 partial 链表、取回 full 链表上的远程释放、
+ * 接管交出的页，最后才申请新页。远程取回只在 partial 为空时扫描，
+ * 扫描代价由随后分配出的整页对象分摊。
+ */
+static receptor_slab_page_t *
+receptor_slab_refill(receptor_slab_cache_t *cache, receptor_slab_class_t *cls, receptor_uint_t slot)
+{
+	receptor_queue_t        *q, *next;
+	receptor_slab_page_t    *page;
+
+	page = cls->current;
+
+	if (page) {
+		page->full = 1;
+		receptor_queue_insert_tail(&cls->full, &page->queue);
+		cls->current = NULL;
+	}
+
+	if (receptor_queue_empty(&cls->partial)) {
+
+		for (q = receptor_queue_head(&cls->full);
+			q != receptor_queue_sentinel(&cls->full);
+			q = next)
+		{
+			next = receptor_queue_next(q);
+			page = receptor_queue_data(q, receptor_slab_page_t, queue);
+
+			if (receptor_slab_collect(page)) {
+				receptor_queue_remove(&page->queue);
+				page->full = 0;
+				receptor_queue_insert_tail(&cls->partial, &page->queue);
+			}
+		}
+
+		if (receptor_queue_empty(&cls->partial)) {
+			receptor_slab_adopt(cache);
+		}
+	}
+
+	if (!receptor_queue_empty(&cls->partial)) {
+		q = receptor_queue_head(&cls->partial);
+		page = receptor_queue_data(q, receptor_slab_page_t, queue);
+		receptor_queue_remove(q);
+	}
+	else {
+		page = receptor_slab_page_create(cache, slot);
+		if (page == NULL) {
+			return NULL;
+		}
+	}
+
+	cls->current = page;
+
+	return page;
+}
+
+RECEPTOR_API void*
+receptor_slab_alloc(size_t size)
+{
+	receptor_uint_t          slot;
+	receptor_slab_obj_t     *obj;
+	receptor_slab_page_t    *page;
+	receptor_slab_class_t   *cls;
+	receptor_slab_cache_t   *cache = &receptor_slab_cache;
+
+	if (size > RECEPTOR_SLAB_MAX_SIZE) {
+		return NULL;
+	}
+
+	if (!cache->inited) {
+		receptor_slab_cache_init(cache);
+	}
+
+	slot = receptor_slab_slot(size);
+	cls = &cache->classes[slot];
+
+	for ( ;; ) {
+		page = cls->current;
+
+		if (page) {
+			obj = page->free;
+
+			if (obj) {
+				page->free = obj->next;
+				page->used++;
+				return obj;
+			}
+
+			if (page->last + page->size <= page->end) {
+				obj = (receptor_slab_obj_t *)page->last;
+				page->last += page->size;
+				page->used++;
+				return obj;
+			}
+
+			if (receptor_slab_collect(page)) {
+				continue;
+			}
+		}
+
+		if (receptor_slab_refill(cache, cls, slot) == NULL) {
+			return NULL;
+		}
+	}
+}
+
+RECEPTOR_API void*
+receptor_slab_calloc(size_t size)
+{
+	void *p;
+
+	p = receptor_slab_alloc(size);
+	if (p) {
+		memset(p, 0, size);
+	}
+
+	return p;
+}
+
+RECEPTOR_API void
+receptor_slab_free(void *p)
+{
+	receptor_slab_obj_t     *obj = p;
+	receptor_slab_obj_t     *head;
+	receptor_slab_page_t    *page;
+	receptor_slab_class_t   *cls;
+	receptor_slab_cache_t   *cache = &receptor_slab_cache;
+
+	if (p == NULL) {
+		return;
+	}
+
+	page = receptor_slab_page_of(p);
+
+	if (receptor_atomic_load_ptr(&page->owner) != cache) {
+		/* 远程释放：只压栈，不取出，因此没有 ABA 问题 */
+		head = receptor_atomic_load_ptr(&page->remote);
+		do {
+			obj->next = head;
+		} while (!receptor_atomic_cas_ptr((void *volatile *)&page->remote, (void **)&head, obj));
+
+		return;
+	}
+
+	obj->next = page->free;
+	page->free = obj;
+	page->used--;
+
+	cls = &cache->classes[page->slot];
+
+	if (page == cls->current) {
+		return;
+	}
+
+	if (page->used == 0) {
+		receptor_queue_remove(&page->queue);
+		receptor_slab_page_free(page);
+		return;
+	}
+
+	if (page->full) {
+		receptor_queue_remove(&page->queue);
+		page->full = 0;
+		receptor_queue_insert_tail(&cls->partial, &page->queue);
+	}
+}
+
+static void
+receptor_slab_release(receptor_slab_page_t *page)
+{
+	receptor_slab_page_t *head;
+
+	receptor_slab_collect(page);
+
+	if (page->used == 0) {
+		receptor_slab_page_free(page);
+		return;
+	}
+
+	(void)receptor_atomic_exchange_ptr(&page->owner, NULL);
+
+	head = receptor_atomic_load_ptr(&receptor_slab_abandoned);
+	do {
+		page->abandoned = head;
+	} while (!receptor_atomic_cas_ptr((void *volatile *)&receptor_slab_abandoned, (void **)&head, page));
+}
+
+static void
+receptor_slab_release_queue(receptor_queue_t *h)
+{
+	receptor_queue_t        *q;
+	receptor_slab_page_t    *page;
+
+	while (!receptor_queue_empty(h)) {
+		q = receptor_queue_head(h);
+		page = receptor_queue_data(q, receptor_slab_page_t, queue);
+		receptor_queue_remove(q);
+
+		receptor_slab_release(page);
+	}
+}
+
+RECEPTOR_API void
+receptor_slab_thread_done(void)
+{
+	receptor_uint_t          i;
+	receptor_slab_class_t   *cls;
+	receptor_slab_cache_t   *cache = &receptor_slab_cache;
+
+	if (!cache->inited) {
+		return;
+	}
+
+	for (i = 0; i < RECEPTOR_SLAB_CLASSES; i++) {
+		cls = &cache->classes[i];
+
+		if (cls->current) {
+			receptor_slab_release(cls->current);
+			cls->current = NULL;
+		}
+
+		receptor_slab_release_queue(&cls->partial);
+		receptor_slab_release_queue(&cls->full);
+	}
+
+	cache->inited = 0;
+}
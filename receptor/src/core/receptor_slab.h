@@ -0,0 +1,66 @@
+#ifndef _RECEPTOR_SLAB_H_
+#define _RECEPTOR_SLAB_H_
+
+#include "receptor/def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 线程本地 slab 分配器 ==================== */
+
+	/**
+	 * 给生命周期短于内存池的小对象使用 (链表节点、请求头等)。
+	 * 对象按大小类取整，每个线程为每个大小类持有自己的页，页按
+	 * RECEPTOR_SLAB_PAGE_SIZE 对齐，释放时由地址直接找到所属页。
+	 * 分配和本线程释放不加锁也不用原子操作；其它线程释放的对象
+	 * 以 CAS 压入页的远程栈，页的所有者在空闲对象用完时一次性取回。
+	 */
+#define RECEPTOR_SLAB_PAGE_SIZE      (64 * 1024)
+#define RECEPTOR_SLAB_MAX_SIZE       1024
+
+	/* ==================== slab 操作API ==================== */
+
+	/**
+	 * @brief 分配一个对象，16 字节对齐，内容未初始化
+	 * @param size 对象大小，不能超过 RECEPTOR_SLAB_MAX_SIZE
+	 * @return 对象指针，size 过大或内存不足时返回 NULL
+	 */
+	RECEPTOR_API void*
+		receptor_slab_alloc(size_t size);
+
+	/**
+	 * @brief 分配一个对象并清零
+	 * @param size 对象大小
+	 * @return 对象指针
+	 */
+	RECEPTOR_API void*
+		receptor_slab_calloc(size_t size);
+
+	/**
+	 * @brief 释放对象，可以在任意线程调用
+	 * @param p receptor_slab_alloc 返回的指针，NULL 时忽略
+	 */
+	RECEPTOR_API void
+		receptor_slab_free(void *p);
+
+	/**
+	 * @brief 释放空页，仍有存活对象的页交出，由下一个缺页的线程接管。
+	 *        使用过 slab 的线程退出时自动调用，也可以提前调用。
+	 */
+	RECEPTOR_API void
+		receptor_slab_thread_done(void);
+
+	/**
+	 * @brief 登记线程退出回调，线程退出时自动调用 receptor_slab_thread_done
+	 *        和 receptor_pool_arena_thread_done。第一次使用 slab 或池块区域时
+	 *        已自动登记，可以重复调用。
+	 */
+	RECEPTOR_API void
+		receptor_slab_thread_register(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_SLAB_H_ */
@@ -1,110 +1,353 @@
 #include <receptor/def.h>
 #include <receptor_event.h>
+#include <receptor_event_posted.h>
 
 #ifdef __linux__
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <errno.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+#ifndef EPOLLRDHUP
+#define EPOLLRDHUP 0x2000
+#endif
 
 /* ==================== Epoll 事件模块实现 ==================== */
 
-#define MAX_EVENTS 64
+/*
+ * 一次 epoll_wait 最多取回 nevents 个事件：取满说明还有积压，容量加倍；
+ * 连续 RECEPTOR_EPOLL_SHRINK_WAITS 次都不到四分之一时减半，
+ * 始终保持在 loop->batch_min 与 loop->batch_max 之间。
+ */
+#define RECEPTOR_EPOLL_SHRINK_WAITS  64
+
+typedef struct {
+	int                     ep;
+	struct epoll_event     *event_list;
+	receptor_uint_t         nevents;
+	receptor_uint_t         idle;       /* 连续低负载的等待次数 */
+} receptor_epoll_loop_t;
+
+static receptor_int_t
+receptor_epoll_resize(receptor_event_loop_t *loop, receptor_epoll_loop_t *el, receptor_uint_t n)
+{
+	struct epoll_event *list;
 
-static int ep = -1;
-static struct epoll_event *event_list;
+	list = realloc(el->event_list, sizeof(struct epoll_event) * n);
+	if (list == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	el->event_list = list;
+	el->nevents = n;
+	receptor_atomic_store_relaxed(&loop->stats.batch, n);
+
+	return RECEPTOR_OK;
+}
 
 static receptor_int_t
-receptor_epoll_init(void)
+receptor_epoll_init(receptor_event_loop_t *loop)
 {
-	ep = epoll_create(1024);
-	if (ep == -1) {
+	receptor_epoll_loop_t  *el;
+
+	el = receptor_pcalloc(loop->pool, sizeof(receptor_epoll_loop_t));
+	if (el == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	el->ep = epoll_create1(EPOLL_CLOEXEC);
+	if (el->ep == -1) {
 		return RECEPTOR_ERROR;
 	}
 
-	event_list = malloc(sizeof(struct epoll_event) * MAX_EVENTS);
-	if (event_list == NULL) {
-		close(ep);
+	if (receptor_epoll_resize(loop, el, loop->batch_min) != RECEPTOR_OK) {
+		close(el->ep);
 		return RECEPTOR_ERROR;
 	}
 
+	loop->backend = el;
+
 	return RECEPTOR_OK;
 }
 
+/*
+ * 读写事件共用同一个描述符，epoll 中每个 fd 只能注册一次：
+ * 另一方向已激活时用 EPOLL_CTL_MOD 合并，否则 EPOLL_CTL_ADD。
+ */
 static receptor_int_t
-receptor_epoll_add_event(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+receptor_epoll_add_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
 {
-	struct epoll_event  ee;
+	receptor_epoll_loop_t  *el = loop->backend;
+	int                     op;
+	uint32_t                events, prev;
+	receptor_event_t       *e;
+	receptor_connection_t  *c;
+	struct epoll_event      ee;
+
+	c = ev->data;
+
+	if (event == RECEPTOR_READ_EVENT) {
+		e = c->write;
+		prev = EPOLLOUT;
+		events = EPOLLIN | EPOLLRDHUP;
+	}
+	else {
+		e = c->read;
+		prev = EPOLLIN | EPOLLRDHUP;
+		events = EPOLLOUT;
+	}
+
+	if (e->active) {
+		op = EPOLL_CTL_MOD;
+		events |= prev;
+	}
+	else {
+		op = EPOLL_CTL_ADD;
+	}
+
+	if (flags & RECEPTOR_CLEAR_EVENT) {
+		events |= EPOLLET;
+	}
 
-	(void)flags;
+	ee.events = events;
+	ee.data.u64 = receptor_event_tag(c, ev->generation);
+
+	if (epoll_ctl(el->ep, op, ev->fd, &ee) == -1) {
+		return RECEPTOR_ERROR;
+	}
 
-	ee.events = 0;
-	ee.data.ptr = ev;
+	ev->active = 1;
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_epoll_del_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	receptor_epoll_loop_t  *el = loop->backend;
+	int                     op;
+	receptor_event_t       *e;
+	receptor_connection_t  *c;
+	struct epoll_event      ee;
 
-	if (event == 1) { /* read */
-		ee.events = EPOLLIN;
+	/* 描述符关闭时内核会自动将其移出 epoll，省掉一次系统调用 */
+	if (flags & RECEPTOR_CLOSE_EVENT) {
+		ev->active = 0;
+		return RECEPTOR_OK;
 	}
-	else if (event == 2) { /* write */
+
+	c = ev->data;
+
+	if (event == RECEPTOR_READ_EVENT) {
+		e = c->write;
 		ee.events = EPOLLOUT;
 	}
+	else {
+		e = c->read;
+		ee.events = EPOLLIN | EPOLLRDHUP;
+	}
 
-	if (epoll_ctl(ep, EPOLL_CTL_ADD, *(int *)ev->data, &ee) == -1) {
+	if (e->active) {
+		op = EPOLL_CTL_MOD;
+		if (flags & RECEPTOR_CLEAR_EVENT) {
+			ee.events |= EPOLLET;
+		}
+		ee.data.u64 = receptor_event_tag(c, ev->generation);
+	}
+	else {
+		op = EPOLL_CTL_DEL;
+		ee.events = 0;
+		ee.data.u64 = 0;
+	}
+
+	if (epoll_ctl(el->ep, op, ev->fd, &ee) == -1) {
 		return RECEPTOR_ERROR;
 	}
 
+	ev->active = 0;
+
 	return RECEPTOR_OK;
 }
 
+/*
+ * 开启忙轮询时先以零超时反复调用 epoll_wait，至多 loop->busy_poll 微秒，
+ * 期间取到事件立即返回，省掉线程睡眠和唤醒的延迟；否则扣除已用的时间后阻塞等待。
+ */
+static int
+receptor_epoll_wait(receptor_event_loop_t *loop, receptor_epoll_loop_t *el, receptor_msec_t timer)
+{
+	int         events;
+	uint64_t    start, spin, elapsed;
+
+	if (loop->busy_poll && timer != 0) {
+		start = receptor_event_time_ns();
+		spin = (uint64_t)loop->busy_poll * 1000;
+
+		if (timer != RECEPTOR_TIMER_INFINITE && spin > (uint64_t)timer * 1000000) {
+			spin = (uint64_t)timer * 1000000;
+		}
+
+		do {
+			events = epoll_wait(el->ep, el->event_list, (int)el->nevents, 0);
+			if (events != 0) {
+				return events;
+			}
+
+			elapsed = receptor_event_time_ns() - start;
+		} while (elapsed < spin);
+
+		if (timer != RECEPTOR_TIMER_INFINITE) {
+			if ((receptor_msec_t)(elapsed / 1000000) >= timer) {
+				return 0;
+			}
+
+			timer -= (receptor_msec_t)(elapsed / 1000000);
+		}
+	}
+
+	return epoll_wait(el->ep, el->event_list, (int)el->nevents, (int)timer);
+}
+
 static receptor_int_t
-receptor_epoll_process_events(void)
+receptor_epoll_process_events(receptor_event_loop_t *loop, receptor_msec_t timer)
 {
-	int                 events;
-	receptor_event_t   *ev;
-	struct epoll_event *ee;
+	receptor_epoll_loop_t  *el = loop->backend;
+	int                     events, i;
+	uint32_t                revents;
+	uint64_t                data;
+	receptor_event_t       *rev, *wev;
+	receptor_connection_t  *c;
 
-	events = epoll_wait(ep, event_list, MAX_EVENTS, -1);
+	events = receptor_epoll_wait(loop, el, timer);
 
 	if (events == -1) {
-		return RECEPTOR_ERROR;
+		return (errno == EINTR) ? RECEPTOR_OK : RECEPTOR_ERROR;
 	}
 
-	for (int i = 0; i < events; i++) {
-		ee = &event_list[i];
-		ev = ee->data.ptr;
+	receptor_event_wakeup(loop, (receptor_uint_t)events);
+
+	for (i = 0; i < events; i++) {
+		data = el->event_list[i].data.u64;
+		c = (receptor_connection_t *)receptor_event_untag(data);
+		rev = c->read;
+
+		/* 本批中前面的处理函数关闭了该连接，连接已被复用 */
+		if (receptor_event_tag_generation(data) != rev->generation) {
+			continue;
+		}
+
+		revents = el->event_list[i].events;
 
-		if (ee->events & EPOLLIN) {
-			ev->handler(ev);
+		/* 错误和挂断交给读写处理函数，由 read()/write() 取得具体错误 */
+		if (revents & (EPOLLERR | EPOLLHUP)) {
+			revents |= EPOLLIN | EPOLLOUT;
 		}
 
-		if (ee->events & EPOLLOUT) {
-			ev->handler(ev);
+		if ((revents & EPOLLIN) && rev->active) {
+			if (revents & EPOLLRDHUP) {
+				rev->pending_eof = 1;
+			}
+
+			rev->ready = 1;
+			receptor_event_dispatch(loop, rev);
+		}
+
+		/* 读处理函数可能已经关闭了连接 */
+		if (c->fd == RECEPTOR_INVALID_SOCKET) {
+			continue;
+		}
+
+		wev = c->write;
+
+		if ((revents & EPOLLOUT) && wev->active) {
+			wev->ready = 1;
+			receptor_event_dispatch(loop, wev);
 		}
 	}
 
+	/* 调整容量放在分发之后，event_list 在分发过程中不能移动 */
+	if (el->nevents > loop->batch_max) {
+		receptor_epoll_resize(loop, el, loop->batch_max);
+	}
+	else if ((receptor_uint_t)events == el->nevents) {
+		el->idle = 0;
+
+		if (el->nevents < loop->batch_max) {
+			receptor_epoll_resize(loop, el,
+				(el->nevents * 2 < loop->batch_max) ? el->nevents * 2 : loop->batch_max);
+		}
+	}
+	else if ((receptor_uint_t)events < el->nevents / 4 && el->nevents > loop->batch_min) {
+		if (++el->idle == RECEPTOR_EPOLL_SHRINK_WAITS) {
+			el->idle = 0;
+			receptor_epoll_resize(loop, el,
+				(el->nevents / 2 > loop->batch_min) ? el->nevents / 2 : loop->batch_min);
+		}
+	}
+	else {
+		el->idle = 0;
+	}
+
 	return RECEPTOR_OK;
 }
 
 static void
-receptor_epoll_done(void)
+receptor_epoll_done(receptor_event_loop_t *loop)
 {
-	if (event_list) {
-		free(event_list);
-		event_list = NULL;
+	receptor_epoll_loop_t  *el = loop->backend;
+
+	if (el == NULL) {
+		return;
+	}
+
+	if (el->event_list) {
+		free(el->event_list);
+		el->event_list = NULL;
 	}
-	if (ep != -1) {
-		close(ep);
-		ep = -1;
+	if (el->ep != -1) {
+		close(el->ep);
+		el->ep = -1;
 	}
+
+	loop->backend = NULL;
+}
+
+/*
+ * SO_BUSY_POLL 让该套接字上的阻塞读在网卡队列上忙等 usec 微秒，
+ * 与循环的忙轮询配合使用时，内核在 epoll_wait 中也会轮询设备队列。
+ */
+RECEPTOR_API receptor_int_t
+receptor_event_socket_busy_poll(receptor_socket_t s, receptor_uint_t usec)
+{
+#ifdef SO_BUSY_POLL
+	int value = (int)usec;
+
+	if (setsockopt(s, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
+#else
+	(void)s;
+	(void)usec;
+	return RECEPTOR_ERROR;
+#endif
 }
 
 /* ==================== Epoll 事件操作结构 ==================== */
 
+/* epoll 下 enable/disable 与 add/del 等价 */
 static const receptor_event_actions_t receptor_epoll_actions = {
 	receptor_epoll_add_event,
-	NULL, /* del */
-	NULL, /* enable */
-	NULL, /* disable */
+	receptor_epoll_del_event,
+	receptor_epoll_add_event,
+	receptor_epoll_del_event,
 	receptor_epoll_process_events,
 	receptor_epoll_init,
-	receptor_epoll_done
+	receptor_epoll_done,
+	NULL, /* notify */
+	NULL  /* recv */
 };
 
 /* ==================== Epoll 模块注册函数 ==================== */
@@ -115,4 +358,4 @@ receptor_event_epoll_register(void)
 	receptor_event_set_actions(&receptor_epoll_actions);
 }
 
-#endif /* __linux__ */
\ No newline at end of file
+#endif /* __linux__ */
@@ -1,5 +1,6 @@
 #include <receptor/def.h>
 #include <receptor_event.h>
+#include <receptor_event_posted.h>
 
 #ifdef _WIN32
 
@@ -7,22 +8,27 @@
 
 /* ==================== IOCP 事件模块实现 ==================== */
 
-static HANDLE iocp_port = NULL;
+/* 每个循环一个完成端口，句柄直接存放在 loop->backend */
 
 static receptor_int_t
-receptor_iocp_init(void)
+receptor_iocp_init(receptor_event_loop_t *loop)
 {
+	HANDLE iocp_port;
+
 	iocp_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 0);
 	if (iocp_port == NULL) {
 		return RECEPTOR_ERROR;
 	}
+
+	loop->backend = iocp_port;
 	return RECEPTOR_OK;
 }
 
 static receptor_int_t
-receptor_iocp_add_event(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+receptor_iocp_add_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
 {
 	/* IOCP 实现 */
+	(void)loop;
 	(void)ev;
 	(void)event;
 	(void)flags;
@@ -30,8 +36,9 @@ receptor_iocp_add_event(receptor_event_t *ev, receptor_int_t event, receptor_uin
 }
 
 static receptor_int_t
-receptor_iocp_process_events(void)
+receptor_iocp_process_events(receptor_event_loop_t *loop, receptor_msec_t timer)
 {
+	HANDLE iocp_port = loop->backend;
 	DWORD bytes_transferred;
 	ULONG_PTR completion_key;
 	LPOVERLAPPED overlapped;
@@ -45,13 +52,15 @@ receptor_iocp_process_events(void)
 		&bytes_transferred,
 		&completion_key,
 		&overlapped,
-		INFINITE
+		(timer == RECEPTOR_TIMER_INFINITE) ? INFINITE : (DWORD)timer
 	);
 
+	receptor_event_wakeup(loop, (result && completion_key) ? 1 : 0);
+
 	if (result && completion_key) {
 		receptor_event_t *ev = (receptor_event_t *)completion_key;
 		if (ev->handler) {
-			ev->handler(ev);
+			receptor_event_dispatch(loop, ev);
 		}
 	}
 
@@ -59,14 +68,25 @@ receptor_iocp_process_events(void)
 }
 
 static void
-receptor_iocp_done(void)
+receptor_iocp_done(receptor_event_loop_t *loop)
 {
-	if (iocp_port) {
-		CloseHandle(iocp_port);
-		iocp_port = NULL;
+	if (loop->backend) {
+		CloseHandle(loop->backend);
+		loop->backend = NULL;
 	}
 }
 
+/* 投递一个以唤醒事件为完成键的空完成包 */
+static receptor_int_t
+receptor_iocp_notify(receptor_event_loop_t *loop)
+{
+	if (!PostQueuedCompletionStatus(loop->backend, 0, (ULONG_PTR)loop->notify->read, NULL)) {
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
+}
+
 /* ==================== IOCP 事件操作结构 ==================== */
 
 static const receptor_event_actions_t receptor_iocp_actions = {
@@ -76,7 +96,9 @@ static const receptor_event_actions_t receptor_iocp_actions = {
 	NULL, /* disable */
 	receptor_iocp_process_events,
 	receptor_iocp_init,
-	receptor_iocp_done
+	receptor_iocp_done,
+	receptor_iocp_notify,
+	NULL  /* recv */
 };
 
 /* ==================== IOCP 模块注册函数 ==================== */
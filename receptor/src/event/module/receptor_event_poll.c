@@ -0,0 +1,262 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_posted.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+
+/* ==================== Poll 事件模块实现 ==================== */
+
+/*
+ * 每个连接在 pollfd 数组中占一项，读写事件共用，c->index 指向该项。
+ * 删除时用末尾元素填补空位，数组始终紧凑，poll() 只扫描有效描述符。
+ */
+
+#define RECEPTOR_POLL_NALLOC    64
+
+typedef struct {
+	struct pollfd              *event_list;
+	receptor_connection_t     **conns;
+	receptor_uint_t             nevents;
+	receptor_uint_t             nalloc;
+} receptor_poll_loop_t;
+
+static receptor_int_t
+receptor_poll_grow(receptor_poll_loop_t *pl)
+{
+	receptor_uint_t             n;
+	struct pollfd              *list;
+	receptor_connection_t     **conns;
+
+	n = pl->nalloc ? pl->nalloc * 2 : RECEPTOR_POLL_NALLOC;
+
+	list = realloc(pl->event_list, n * sizeof(struct pollfd));
+	if (list == NULL) {
+		return RECEPTOR_ERROR;
+	}
+	pl->event_list = list;
+
+	conns = realloc(pl->conns, n * sizeof(receptor_connection_t *));
+	if (conns == NULL) {
+		return RECEPTOR_ERROR;
+	}
+	pl->conns = conns;
+
+	pl->nalloc = n;
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_poll_init(receptor_event_loop_t *loop)
+{
+	receptor_poll_loop_t *pl;
+
+	pl = receptor_pcalloc(loop->pool, sizeof(receptor_poll_loop_t));
+	if (pl == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	if (receptor_poll_grow(pl) != RECEPTOR_OK) {
+		free(pl->event_list);
+		return RECEPTOR_ERROR;
+	}
+
+	loop->backend = pl;
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_poll_add_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	receptor_poll_loop_t   *pl = loop->backend;
+	short                   events;
+	receptor_event_t       *e;
+	receptor_connection_t  *c;
+
+	(void)flags;
+
+	c = ev->data;
+
+	if (event == RECEPTOR_READ_EVENT) {
+		e = c->write;
+		events = POLLIN;
+	}
+	else {
+		e = c->read;
+		events = POLLOUT;
+	}
+
+	/* 另一方向已在数组中，合并到同一项 */
+	if (e->active) {
+		pl->event_list[c->index].events |= events;
+		ev->active = 1;
+		return RECEPTOR_OK;
+	}
+
+	if (pl->nevents == pl->nalloc && receptor_poll_grow(pl) != RECEPTOR_OK) {
+		return RECEPTOR_ERROR;
+	}
+
+	c->index = pl->nevents;
+	pl->event_list[c->index].fd = ev->fd;
+	pl->event_list[c->index].events = events;
+	pl->event_list[c->index].revents = 0;
+	pl->conns[c->index] = c;
+	pl->nevents++;
+
+	ev->active = 1;
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_poll_del_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	receptor_poll_loop_t   *pl = loop->backend;
+	receptor_uint_t         last;
+	receptor_event_t       *e;
+	receptor_connection_t  *c, *m;
+
+	(void)flags;
+
+	if (!ev->active) {
+		return RECEPTOR_OK;
+	}
+
+	c = ev->data;
+	ev->active = 0;
+
+	if (event == RECEPTOR_READ_EVENT) {
+		e = c->write;
+		if (e->active) {
+			pl->event_list[c->index].events &= ~POLLIN;
+			return RECEPTOR_OK;
+		}
+	}
+	else {
+		e = c->read;
+		if (e->active) {
+			pl->event_list[c->index].events &= ~POLLOUT;
+			return RECEPTOR_OK;
+		}
+	}
+
+	/* 两个方向都已删除，用末尾元素填补 */
+	last = pl->nevents - 1;
+
+	if (c->index != last) {
+		pl->event_list[c->index] = pl->event_list[last];
+		m = pl->conns[last];
+		pl->conns[c->index] = m;
+		m->index = c->index;
+	}
+
+	pl->nevents--;
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_poll_process_events(receptor_event_loop_t *loop, receptor_msec_t timer)
+{
+	receptor_poll_loop_t   *pl = loop->backend;
+	int                     ready;
+	short                   revents;
+	receptor_uint_t         i;
+	receptor_event_t       *rev, *wev;
+	receptor_connection_t  *c;
+
+	ready = poll(pl->event_list, (nfds_t)pl->nevents, (int)timer);
+
+	if (ready == -1) {
+		return (errno == EINTR) ? RECEPTOR_OK : RECEPTOR_ERROR;
+	}
+
+	receptor_event_wakeup(loop, (receptor_uint_t)ready);
+
+	/*
+	 * 处理函数可能删除当前项，末尾元素会被搬到 i，
+	 * 因此处理过的项先清空 revents，搬来的项若有事件则留在 i 继续处理。
+	 */
+	for (i = 0; i < pl->nevents && ready > 0; /* void */) {
+		revents = pl->event_list[i].revents;
+
+		if (revents == 0) {
+			i++;
+			continue;
+		}
+
+		pl->event_list[i].revents = 0;
+		c = pl->conns[i];
+		ready--;
+
+		if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+			revents |= POLLIN | POLLOUT;
+		}
+
+		rev = c->read;
+
+		if ((revents & POLLIN) && rev->active) {
+			rev->ready = 1;
+			receptor_event_dispatch(loop, rev);
+		}
+
+		wev = c->write;
+
+		if (c->fd != RECEPTOR_INVALID_SOCKET && (revents & POLLOUT) && wev->active) {
+			wev->ready = 1;
+			receptor_event_dispatch(loop, wev);
+		}
+
+		if (i < pl->nevents && pl->event_list[i].revents != 0) {
+			continue;
+		}
+
+		i++;
+	}
+
+	return RECEPTOR_OK;
+}
+
+static void
+receptor_poll_done(receptor_event_loop_t *loop)
+{
+	receptor_poll_loop_t *pl = loop->backend;
+
+	if (pl == NULL) {
+		return;
+	}
+
+	free(pl->event_list);
+	free(pl->conns);
+
+	loop->backend = NULL;
+}
+
+/* ==================== Poll 事件操作结构 ==================== */
+
+static const receptor_event_actions_t receptor_poll_actions = {
+	receptor_poll_add_event,
+	receptor_poll_del_event,
+	receptor_poll_add_event,
+	receptor_poll_del_event,
+	receptor_poll_process_events,
+	receptor_poll_init,
+	receptor_poll_done,
+	NULL, /* notify */
+	NULL  /* recv */
+};
+
+/* ==================== Poll 模块注册函数 ==================== */
+
+RECEPTOR_API void
+receptor_event_poll_register(void)
+{
+	receptor_event_set_actions(&receptor_poll_actions);
+}
+
+#endif /* _WIN32 */
@@ -1,5 +1,6 @@
 #include <receptor/def.h>
 #include <receptor_event.h>
+#include <receptor_event_posted.h>
 #include <stdlib.h>
 
 #ifdef _WIN32
@@ -8,54 +9,274 @@
 #include <sys/select.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <errno.h>
 #include <unistd.h>
 #endif
 
 /* ==================== Select 事件模块实现 ==================== */
 
+/*
+ * 与 poll 后端相同，每个连接在 conns 中占一项，读写事件共用，c->index 指向该项，
+ * 删除时用末尾元素填补。读写事件分别放入两个 fd_set。
+ */
+
+typedef struct {
+	fd_set                  master_read;
+	fd_set                  master_write;
+	fd_set                  work_read;
+	fd_set                  work_write;
+	receptor_connection_t **conns;
+	receptor_uint_t         nconns;
+	receptor_socket_t       max_fd;     /* -1 表示需要重新计算，Windows 下不使用 */
+} receptor_select_loop_t;
+
 static receptor_int_t
-receptor_select_init(void)
+receptor_select_init(receptor_event_loop_t *loop)
 {
+	receptor_select_loop_t *sl;
+
+	sl = receptor_pcalloc(loop->pool, sizeof(receptor_select_loop_t));
+	if (sl == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	FD_ZERO(&sl->master_read);
+	FD_ZERO(&sl->master_write);
+
+	/* Windows 下两个集合各自最多 FD_SETSIZE 个套接字 */
+	sl->conns = malloc(2 * FD_SETSIZE * sizeof(receptor_connection_t *));
+	if (sl->conns == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	sl->max_fd = (receptor_socket_t)-1;
+	loop->backend = sl;
+
 	return RECEPTOR_OK;
 }
 
 static receptor_int_t
-receptor_select_add_event(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+receptor_select_add_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
 {
-	(void)ev;
-	(void)event;
+	receptor_select_loop_t *sl = loop->backend;
+	receptor_connection_t  *c = ev->data;
+	receptor_event_t       *e;
+
 	(void)flags;
+
+	if (ev->active) {
+		return RECEPTOR_OK;
+	}
+
+#ifdef _WIN32
+	if ((event == RECEPTOR_READ_EVENT && sl->master_read.fd_count >= FD_SETSIZE)
+		|| (event == RECEPTOR_WRITE_EVENT && sl->master_write.fd_count >= FD_SETSIZE))
+	{
+		return RECEPTOR_ERROR;
+	}
+#else
+	if (ev->fd < 0 || ev->fd >= FD_SETSIZE) {
+		return RECEPTOR_ERROR;
+	}
+#endif
+
+	if (event == RECEPTOR_READ_EVENT) {
+		FD_SET(ev->fd, &sl->master_read);
+		ev->write = 0;
+		e = c->write;
+	}
+	else {
+		FD_SET(ev->fd, &sl->master_write);
+		ev->write = 1;
+		e = c->read;
+	}
+
+#ifndef _WIN32
+	if (sl->max_fd != -1 && ev->fd > sl->max_fd) {
+		sl->max_fd = ev->fd;
+	}
+#endif
+
+	ev->active = 1;
+
+	/* 另一方向已在数组中 */
+	if (e->active) {
+		return RECEPTOR_OK;
+	}
+
+	c->index = sl->nconns;
+	sl->conns[sl->nconns++] = c;
+
 	return RECEPTOR_OK;
 }
 
 static receptor_int_t
-receptor_select_process_events(void)
+receptor_select_del_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
 {
-	/* 简单的 select 实现 */
+	receptor_select_loop_t *sl = loop->backend;
+	receptor_connection_t  *c = ev->data;
+	receptor_connection_t  *m;
+	receptor_event_t       *e;
+
+	(void)flags;
+
+	if (!ev->active) {
+		return RECEPTOR_OK;
+	}
+
+	ev->active = 0;
+
+	if (event == RECEPTOR_READ_EVENT) {
+		FD_CLR(ev->fd, &sl->master_read);
+		FD_CLR(ev->fd, &sl->work_read);
+		e = c->write;
+	}
+	else {
+		FD_CLR(ev->fd, &sl->master_write);
+		FD_CLR(ev->fd, &sl->work_write);
+		e = c->read;
+	}
+
+	if (e->active) {
+		return RECEPTOR_OK;
+	}
+
+#ifndef _WIN32
+	if (ev->fd == sl->max_fd) {
+		sl->max_fd = -1;
+	}
+#endif
+
+	/* 两个方向都已删除，用末尾元素填补 */
+	if (c->index < --sl->nconns) {
+		m = sl->conns[sl->nconns];
+		sl->conns[c->index] = m;
+		m->index = c->index;
+	}
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_select_process_events(receptor_event_loop_t *loop, receptor_msec_t timer)
+{
+	receptor_select_loop_t *sl = loop->backend;
+	int                     ready, nfds;
+	receptor_uint_t         i;
+	receptor_event_t       *rev, *wev;
+	receptor_connection_t  *c;
+	struct timeval          tv, *tp;
+
+	nfds = 0;
+
+#ifndef _WIN32
+	if (sl->max_fd == -1) {
+		for (i = 0; i < sl->nconns; i++) {
+			c = sl->conns[i];
+			if (c->fd > sl->max_fd) {
+				sl->max_fd = c->fd;
+			}
+		}
+	}
+
+	nfds = sl->max_fd + 1;
+#else
+	/* Windows 的 select 不允许三个集合都为空 */
+	if (sl->nconns == 0) {
+		Sleep((timer == RECEPTOR_TIMER_INFINITE) ? INFINITE : (DWORD)timer);
+		return RECEPTOR_OK;
+	}
+#endif
+
+	if (timer == RECEPTOR_TIMER_INFINITE) {
+		tp = NULL;
+	}
+	else {
+		tv.tv_sec = (long)(timer / 1000);
+		tv.tv_usec = (long)((timer % 1000) * 1000);
+		tp = &tv;
+	}
+
+	sl->work_read = sl->master_read;
+	sl->work_write = sl->master_write;
+
+	ready = select(nfds, &sl->work_read, &sl->work_write, NULL, tp);
+
+	if (ready == -1) {
 #ifdef _WIN32
-	Sleep(100);  /* Windows 休眠 */
+		return RECEPTOR_ERROR;
 #else
-	usleep(100000);  /* Unix 休眠 100ms */
+		return (errno == EINTR) ? RECEPTOR_OK : RECEPTOR_ERROR;
 #endif
+	}
+
+	receptor_event_wakeup(loop, (receptor_uint_t)ready);
+
+	/*
+	 * 处理函数可能删除连接，末尾元素会被搬到 i；处理过的描述符
+	 * 已从工作集合中清除，因此 i 处搬来的连接可以安全地再检查一次。
+	 */
+	for (i = 0; i < sl->nconns && ready > 0; /* void */) {
+		c = sl->conns[i];
+		rev = c->read;
+
+		if (rev->active && FD_ISSET(rev->fd, &sl->work_read)) {
+			FD_CLR(rev->fd, &sl->work_read);
+			ready--;
+
+			rev->ready = 1;
+			receptor_event_dispatch(loop, rev);
+
+			if (i >= sl->nconns || sl->conns[i] != c) {
+				continue;
+			}
+		}
+
+		wev = c->write;
+
+		if (wev->active && FD_ISSET(wev->fd, &sl->work_write)) {
+			FD_CLR(wev->fd, &sl->work_write);
+			ready--;
+
+			wev->ready = 1;
+			receptor_event_dispatch(loop, wev);
+
+			if (i >= sl->nconns || sl->conns[i] != c) {
+				continue;
+			}
+		}
+
+		i++;
+	}
+
 	return RECEPTOR_OK;
 }
 
 static void
-receptor_select_done(void)
+receptor_select_done(receptor_event_loop_t *loop)
 {
-	/* 清理资源 */
+	receptor_select_loop_t *sl = loop->backend;
+
+	if (sl == NULL) {
+		return;
+	}
+
+	free(sl->conns);
+	loop->backend = NULL;
 }
 
 /* ==================== Select 事件操作结构 ==================== */
 
 static const receptor_event_actions_t receptor_select_actions = {
 	receptor_select_add_event,
-	NULL, /* del */
-	NULL, /* enable */
-	NULL, /* disable */
+	receptor_select_del_event,
+	receptor_select_add_event,
+	receptor_select_del_event,
 	receptor_select_process_events,
 	receptor_select_init,
-	receptor_select_done
+	receptor_select_done,
+	NULL, /* notify */
+	NULL  /* recv */
 };
 
 /* ==================== Select 模块注册函数 ==================== */
@@ -64,4 +285,4 @@ RECEPTOR_API void
 receptor_event_select_register(void)
 {
 	receptor_event_set_actions(&receptor_select_actions);
-}
\ No newline at end of file
+}
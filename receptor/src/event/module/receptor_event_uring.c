@@ -0,0 +1,762 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_posted.h>
+#include <receptor_event_listen.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef POLLRDHUP
+#define POLLRDHUP 0x2000
+#endif
+
+/* ==================== io_uring 事件模块实现 ==================== */
+
+/*
+ * add/del 只写入 SQE，不产生系统调用，所有提交在 process_events 中
+ * 与等待合并为一次 io_uring_enter。
+ *
+ * 就绪通知通过 IORING_OP_POLL_ADD 实现：边沿触发的事件使用 multishot
+ * poll，一次注册持续产生完成；水平触发的事件使用 oneshot，分发前重新提交。
+ * 监听套接字改用 multishot accept，每个完成直接带着新连接的描述符，
+ * 交给 receptor_event_accept_socket，不再为每个连接调用 accept()。
+ * 以 RECEPTOR_RECV_EVENT | RECEPTOR_CLEAR_EVENT 注册的读事件改用
+ * multishot recv，数据由内核收进提供缓冲区环，处理函数通过
+ * receptor_event_recv 直接从缓冲区拷贝，读空时不再调用 recv() 试探。
+ * 内核不支持这两项时 (accept 5.19，recv 6.0) 退回 poll。
+ *
+ * user_data 低三位标记方向、触发方式和请求类型，事件结构至少 8 字节对齐；
+ * 高 16 位为事件的代数，连接复用后旧请求的完成据此丢弃。
+ * 撤销请求按 user_data 匹配，提交时的标记记在 ev->armed 中，
+ * 删除时不能按 del 的参数重建 (关闭连接时只传 RECEPTOR_CLOSE_EVENT)。
+ */
+
+#define RECEPTOR_URING_ENTRIES      256
+
+#define RECEPTOR_URING_WRITE        0x1
+#define RECEPTOR_URING_CLEAR        0x2
+#define RECEPTOR_URING_IO           0x4     /* multishot accept/recv，而不是 poll */
+#define RECEPTOR_URING_TAGS         0x7
+#define RECEPTOR_URING_ARMED        0x8     /* 只记在 ev->armed 中：请求仍在内核中 */
+
+/* 提供缓冲区环：个数为 2 的幂，每个连接上未读走的缓冲区串在 c->recv_buf 上 */
+#define RECEPTOR_URING_BUFS         256
+#define RECEPTOR_URING_BUF_SIZE     4096
+#define RECEPTOR_URING_BGID         0
+
+typedef struct receptor_uring_buf_s  receptor_uring_buf_t;
+
+/* 缓冲区在数组中的下标即 bid；连接上的链表为循环链表，c->recv_buf 指向尾部 */
+struct receptor_uring_buf_s {
+	receptor_uring_buf_t   *next;
+	u_char                 *pos;
+	u_char                 *last;
+};
+
+typedef struct {
+	int                     fd;
+
+	void                   *sq_ring;
+	size_t                  sq_ring_size;
+	unsigned               *sq_head;
+	unsigned               *sq_tail;
+	unsigned               *sq_mask;
+	unsigned               *sq_array;
+	struct io_uring_sqe    *sqes;
+	size_t                  sqes_size;
+	unsigned                sq_pending;
+
+	void                   *cq_ring;
+	size_t                  cq_ring_size;
+	unsigned               *cq_head;
+	unsigned               *cq_tail;
+	unsigned               *cq_mask;
+	struct io_uring_cqe    *cqes;
+
+	/* 注册失败时 br 为 NULL，与 recv_multishot 清零一样，RECEPTOR_RECV_EVENT 退回 poll */
+	struct io_uring_buf_ring *br;
+	u_char                 *buf_data;
+	receptor_uring_buf_t   *bufs;
+	unsigned                br_tail;
+
+	receptor_uint_t         accept_multishot;  /* 内核拒绝后清零，监听退回 poll */
+	receptor_uint_t         recv_multishot;
+} receptor_uring_loop_t;
+
+static int
+receptor_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+receptor_uring_register(int fd, unsigned opcode, void *arg, unsigned n)
+{
+	return (int)syscall(__NR_io_uring_register, fd, opcode, arg, n);
+}
+
+static int
+receptor_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* 带超时的等待 (IORING_ENTER_EXT_ARG, 5.11) */
+static int
+receptor_uring_wait(int fd, unsigned to_submit, receptor_msec_t timer)
+{
+	struct __kernel_timespec        ts;
+	struct io_uring_getevents_arg   arg;
+
+	if (timer == RECEPTOR_TIMER_INFINITE) {
+		return receptor_uring_enter(fd, to_submit, 1, IORING_ENTER_GETEVENTS);
+	}
+
+	ts.tv_sec = timer / 1000;
+	ts.tv_nsec = (timer % 1000) * 1000000;
+
+	memset(&arg, 0, sizeof(struct io_uring_getevents_arg));
+	arg.ts = (uintptr_t)&ts;
+
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, 1,
+		IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+static void
+receptor_uring_unmap(receptor_uring_loop_t *ul)
+{
+	if (ul->sqes && ul->sqes != MAP_FAILED) {
+		munmap(ul->sqes, ul->sqes_size);
+	}
+
+	if (ul->cq_ring && ul->cq_ring != MAP_FAILED && ul->cq_ring != ul->sq_ring) {
+		munmap(ul->cq_ring, ul->cq_ring_size);
+	}
+
+	if (ul->sq_ring && ul->sq_ring != MAP_FAILED) {
+		munmap(ul->sq_ring, ul->sq_ring_size);
+	}
+
+	if (ul->fd != -1) {
+		close(ul->fd);
+		ul->fd = -1;
+	}
+
+	/* 环关闭后内核不再访问缓冲区 */
+	if (ul->br) {
+		munmap(ul->br, RECEPTOR_URING_BUFS * sizeof(struct io_uring_buf));
+		munmap(ul->buf_data, (size_t)RECEPTOR_URING_BUFS * RECEPTOR_URING_BUF_SIZE);
+		ul->br = NULL;
+	}
+}
+
+/* 将已写入的 SQE 提交给内核，不等待完成 */
+static receptor_int_t
+receptor_uring_flush(receptor_uring_loop_t *ul)
+{
+	int n;
+
+	while (ul->sq_pending) {
+		n = receptor_uring_enter(ul->fd, ul->sq_pending, 0, 0);
+		if (n == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return RECEPTOR_ERROR;
+		}
+
+		ul->sq_pending -= (unsigned)n;
+	}
+
+	return RECEPTOR_OK;
+}
+
+static struct io_uring_sqe *
+receptor_uring_get_sqe(receptor_uring_loop_t *ul)
+{
+	unsigned              head, tail;
+	struct io_uring_sqe  *sqe;
+
+	head = __atomic_load_n(ul->sq_head, __ATOMIC_ACQUIRE);
+	tail = *ul->sq_tail;
+
+	/* 提交队列已满，先把积压的请求交给内核 */
+	if (tail - head > *ul->sq_mask) {
+		if (receptor_uring_flush(ul) != RECEPTOR_OK) {
+			return NULL;
+		}
+	}
+
+	sqe = &ul->sqes[tail & *ul->sq_mask];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+	ul->sq_array[tail & *ul->sq_mask] = tail & *ul->sq_mask;
+	__atomic_store_n(ul->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ul->sq_pending++;
+
+	return sqe;
+}
+
+/* 缓冲区交还内核；只写 addr/len/bid，环的 tail 与第 0 项的 resv 重叠 */
+static void
+receptor_uring_buf_put(receptor_uring_loop_t *ul, receptor_uring_buf_t *b)
+{
+	unsigned             bid;
+	struct io_uring_buf *rb;
+
+	bid = (unsigned)(b - ul->bufs);
+	rb = &ul->br->bufs[ul->br_tail & (RECEPTOR_URING_BUFS - 1)];
+
+	rb->addr = (uintptr_t)(ul->buf_data + (size_t)bid * RECEPTOR_URING_BUF_SIZE);
+	rb->len = RECEPTOR_URING_BUF_SIZE;
+	rb->bid = (uint16_t)bid;
+
+	ul->br_tail++;
+	__atomic_store_n(&ul->br->tail, (uint16_t)ul->br_tail, __ATOMIC_RELEASE);
+}
+
+/* 连接上尚未读走的缓冲区全部交还 */
+static void
+receptor_uring_buf_release(receptor_uring_loop_t *ul, receptor_connection_t *c)
+{
+	receptor_uring_buf_t *b, *next, *tail;
+
+	tail = c->recv_buf;
+	if (tail == NULL) {
+		return;
+	}
+
+	b = tail->next;
+
+	for ( ;; ) {
+		next = b->next;
+		receptor_uring_buf_put(ul, b);
+
+		if (b == tail) {
+			break;
+		}
+
+		b = next;
+	}
+
+	c->recv_buf = NULL;
+}
+
+static receptor_int_t
+receptor_uring_init_bufs(receptor_uring_loop_t *ul, receptor_pool_t *pool)
+{
+	unsigned                 i;
+	struct io_uring_buf_reg  reg;
+
+	ul->bufs = receptor_pcalloc(pool, RECEPTOR_URING_BUFS * sizeof(receptor_uring_buf_t));
+	if (ul->bufs == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	ul->br = mmap(NULL, RECEPTOR_URING_BUFS * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ul->br == MAP_FAILED) {
+		ul->br = NULL;
+		return RECEPTOR_ERROR;
+	}
+
+	ul->buf_data = mmap(NULL, (size_t)RECEPTOR_URING_BUFS * RECEPTOR_URING_BUF_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ul->buf_data == MAP_FAILED) {
+		munmap(ul->br, RECEPTOR_URING_BUFS * sizeof(struct io_uring_buf));
+		ul->br = NULL;
+		return RECEPTOR_ERROR;
+	}
+
+	memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+	reg.ring_addr = (uintptr_t)ul->br;
+	reg.ring_entries = RECEPTOR_URING_BUFS;
+	reg.bgid = RECEPTOR_URING_BGID;
+
+	/* IORING_REGISTER_PBUF_RING 需要 5.19 */
+	if (receptor_uring_register(ul->fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+		munmap(ul->buf_data, (size_t)RECEPTOR_URING_BUFS * RECEPTOR_URING_BUF_SIZE);
+		munmap(ul->br, RECEPTOR_URING_BUFS * sizeof(struct io_uring_buf));
+		ul->br = NULL;
+		return RECEPTOR_ERROR;
+	}
+
+	for (i = 0; i < RECEPTOR_URING_BUFS; i++) {
+		receptor_uring_buf_put(ul, &ul->bufs[i]);
+	}
+
+	return RECEPTOR_OK;
+}
+
+/* 按 tags 提交 poll、multishot accept 或 multishot recv，内核不支持的退回 poll */
+static receptor_int_t
+receptor_uring_arm(receptor_uring_loop_t *ul, receptor_event_t *ev, uintptr_t tags)
+{
+	struct io_uring_sqe    *sqe;
+
+	if (tags & RECEPTOR_URING_IO) {
+		if (ev->accept ? !ul->accept_multishot : (ul->br == NULL || !ul->recv_multishot)) {
+			tags &= ~(uintptr_t)RECEPTOR_URING_IO;
+		}
+	}
+
+	sqe = receptor_uring_get_sqe(ul);
+	if (sqe == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	sqe->fd = ev->fd;
+	sqe->user_data = receptor_event_tag((uintptr_t)ev | tags, ev->generation);
+
+	ev->armed = (uint32_t)(tags | RECEPTOR_URING_ARMED);
+
+	if (!(tags & RECEPTOR_URING_IO)) {
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->poll32_events = (tags & RECEPTOR_URING_WRITE) ? POLLOUT : (POLLIN | POLLRDHUP);
+
+		if (tags & RECEPTOR_URING_CLEAR) {
+			sqe->len = IORING_POLL_ADD_MULTI;
+		}
+
+		return RECEPTOR_OK;
+	}
+
+	if (ev->accept) {
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+		sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+		return RECEPTOR_OK;
+	}
+
+	sqe->opcode = IORING_OP_RECV;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = RECEPTOR_URING_BGID;
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_uring_init(receptor_event_loop_t *loop)
+{
+	receptor_uring_loop_t    *ul;
+	struct io_uring_params    p;
+
+	ul = receptor_pcalloc(loop->pool, sizeof(receptor_uring_loop_t));
+	if (ul == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	memset(&p, 0, sizeof(struct io_uring_params));
+
+	ul->fd = receptor_uring_setup(RECEPTOR_URING_ENTRIES, &p);
+
+	/*
+	 * 内核不支持 io_uring 或缺少 multishot poll (5.13, 与 RSRC_TAGS 同版本)
+	 * 时退回 epoll；此后新建的循环也直接使用 epoll。
+	 */
+	if (ul->fd == -1
+		|| !(p.features & IORING_FEAT_SINGLE_MMAP)
+		|| !(p.features & IORING_FEAT_RSRC_TAGS))
+	{
+		if (ul->fd != -1) {
+			close(ul->fd);
+		}
+
+		receptor_event_epoll_register();
+		loop->actions = receptor_event_actions;
+		return loop->actions.init(loop);
+	}
+
+	ul->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ul->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (ul->cq_ring_size > ul->sq_ring_size) {
+		ul->sq_ring_size = ul->cq_ring_size;
+	}
+
+	ul->sq_ring = mmap(NULL, ul->sq_ring_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ul->fd, IORING_OFF_SQ_RING);
+	if (ul->sq_ring == MAP_FAILED) {
+		receptor_uring_unmap(ul);
+		return RECEPTOR_ERROR;
+	}
+
+	ul->cq_ring = ul->sq_ring;
+	ul->cq_ring_size = ul->sq_ring_size;
+
+	ul->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+	ul->sqes = mmap(NULL, ul->sqes_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ul->fd, IORING_OFF_SQES);
+	if (ul->sqes == MAP_FAILED) {
+		receptor_uring_unmap(ul);
+		return RECEPTOR_ERROR;
+	}
+
+	ul->sq_head = (unsigned *)((char *)ul->sq_ring + p.sq_off.head);
+	ul->sq_tail = (unsigned *)((char *)ul->sq_ring + p.sq_off.tail);
+	ul->sq_mask = (unsigned *)((char *)ul->sq_ring + p.sq_off.ring_mask);
+	ul->sq_array = (unsigned *)((char *)ul->sq_ring + p.sq_off.array);
+
+	ul->cq_head = (unsigned *)((char *)ul->cq_ring + p.cq_off.head);
+	ul->cq_tail = (unsigned *)((char *)ul->cq_ring + p.cq_off.tail);
+	ul->cq_mask = (unsigned *)((char *)ul->cq_ring + p.cq_off.ring_mask);
+	ul->cqes = (struct io_uring_cqe *)((char *)ul->cq_ring + p.cq_off.cqes);
+
+	/* 缓冲区环注册失败不影响其它功能 */
+	(void)receptor_uring_init_bufs(ul, loop->pool);
+	ul->accept_multishot = 1;
+	ul->recv_multishot = 1;
+
+	loop->backend = ul;
+	receptor_atomic_store_relaxed(&loop->stats.batch, p.cq_entries);
+
+	return RECEPTOR_OK;
+}
+
+static receptor_int_t
+receptor_uring_add_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	uintptr_t tags = 0;
+
+	if (event == RECEPTOR_WRITE_EVENT) {
+		tags |= RECEPTOR_URING_WRITE;
+	}
+
+	if (flags & RECEPTOR_CLEAR_EVENT) {
+		tags |= RECEPTOR_URING_CLEAR;
+	}
+
+	if (event == RECEPTOR_READ_EVENT
+		&& (ev->accept
+			|| (flags & (RECEPTOR_RECV_EVENT | RECEPTOR_CLEAR_EVENT)) == (RECEPTOR_RECV_EVENT | RECEPTOR_CLEAR_EVENT)))
+	{
+		tags |= RECEPTOR_URING_IO;
+	}
+
+	if (receptor_uring_arm(loop->backend, ev, tags) != RECEPTOR_OK) {
+		return RECEPTOR_ERROR;
+	}
+
+	ev->active = 1;
+
+	return RECEPTOR_OK;
+}
+
+/*
+ * io_uring 持有文件引用，close() 不会撤销请求，
+ * 因此即使带 RECEPTOR_CLOSE_EVENT 也要提交 POLL_REMOVE / ASYNC_CANCEL。
+ * 连接上尚未读走的缓冲区一并交还。
+ */
+static receptor_int_t
+receptor_uring_del_event(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	uintptr_t               tags;
+	struct io_uring_sqe    *sqe;
+	receptor_uring_loop_t  *ul = loop->backend;
+
+	(void)event;
+	(void)flags;
+
+	if (!ev->active) {
+		return RECEPTOR_OK;
+	}
+
+	tags = ev->armed & RECEPTOR_URING_TAGS;
+
+	if (ev->armed & RECEPTOR_URING_ARMED) {
+		sqe = receptor_uring_get_sqe(ul);
+		if (sqe == NULL) {
+			return RECEPTOR_ERROR;
+		}
+
+		sqe->opcode = (tags & RECEPTOR_URING_IO) ? IORING_OP_ASYNC_CANCEL : IORING_OP_POLL_REMOVE;
+		sqe->fd = -1;
+		sqe->addr = receptor_event_tag((uintptr_t)ev | tags, ev->generation);
+		sqe->user_data = tags & RECEPTOR_URING_IO;
+	}
+
+	if (!ev->write && !ev->accept) {
+		receptor_uring_buf_release(ul, ev->data);
+	}
+
+	ev->active = 0;
+	ev->armed = 0;
+
+	return RECEPTOR_OK;
+}
+
+/*
+ * multishot recv 仍在进行时只从缓冲区拷贝；请求已终止 (缓冲区用完、
+ * 对端关闭或出错) 时退回 recv()，得到 EOF 或错误，读空后重新提交。
+ */
+static receptor_int_t
+receptor_uring_recv(receptor_event_loop_t *loop, receptor_connection_t *c, void *buf, size_t size)
+{
+	size_t                  n, len;
+	ssize_t                 rc;
+	receptor_event_t       *rev = c->read;
+	receptor_uring_buf_t   *b, *tail;
+	receptor_uring_loop_t  *ul = loop->backend;
+
+	n = 0;
+	tail = c->recv_buf;
+
+	while (tail && n < size) {
+		b = tail->next;
+
+		len = (size_t)(b->last - b->pos);
+		if (len > size - n) {
+			len = size - n;
+		}
+
+		memcpy((u_char *)buf + n, b->pos, len);
+		b->pos += len;
+		n += len;
+
+		if (b->pos == b->last) {
+			if (b == tail) {
+				tail = NULL;
+			}
+			else {
+				tail->next = b->next;
+			}
+
+			receptor_uring_buf_put(ul, b);
+		}
+	}
+
+	c->recv_buf = tail;
+
+	if (n) {
+		return (receptor_int_t)n;
+	}
+
+	if ((rev->armed & (RECEPTOR_URING_IO | RECEPTOR_URING_ARMED)) == (RECEPTOR_URING_IO | RECEPTOR_URING_ARMED)) {
+		rev->ready = 0;
+		errno = EAGAIN;
+		return -1;
+	}
+
+	rc = recv(c->fd, buf, size, 0);
+
+	if (rc == -1 && errno == EAGAIN && rev->active && (rev->armed & RECEPTOR_URING_IO)) {
+		rev->ready = 0;
+
+		if (receptor_uring_arm(ul, rev, rev->armed & RECEPTOR_URING_TAGS) != RECEPTOR_OK) {
+			rev->error = 1;
+		}
+
+		errno = EAGAIN;
+	}
+
+	return (receptor_int_t)rc;
+}
+
+/* 连接上的缓冲区循环链表，新收到的追加在尾部 */
+static void
+receptor_uring_recv_done(receptor_uring_loop_t *ul, receptor_event_t *ev, struct io_uring_cqe *cqe)
+{
+	receptor_uring_buf_t   *b;
+	receptor_connection_t  *c = ev->data;
+
+	if (!(cqe->flags & IORING_CQE_F_MORE)) {
+		ev->armed &= ~RECEPTOR_URING_ARMED;
+
+		/* 内核不支持 multishot recv，之后的读事件都用 poll */
+		if (cqe->res == -EINVAL) {
+			ul->recv_multishot = 0;
+		}
+	}
+
+	if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER)) {
+		b = &ul->bufs[cqe->flags >> IORING_CQE_BUFFER_SHIFT];
+		b->pos = ul->buf_data + (size_t)(b - ul->bufs) * RECEPTOR_URING_BUF_SIZE;
+		b->last = b->pos + cqe->res;
+
+		if (c->recv_buf) {
+			b->next = ((receptor_uring_buf_t *)c->recv_buf)->next;
+			((receptor_uring_buf_t *)c->recv_buf)->next = b;
+		}
+		else {
+			b->next = b;
+		}
+
+		c->recv_buf = b;
+	}
+}
+
+static receptor_int_t
+receptor_uring_process_events(receptor_event_loop_t *loop, receptor_msec_t timer)
+{
+	receptor_uring_loop_t  *ul = loop->backend;
+	int                     n;
+	unsigned                head, tail;
+	uint64_t                ud;
+	receptor_event_t       *ev;
+	struct io_uring_cqe    *cqe;
+
+	/* 一次系统调用完成提交与等待 */
+	head = *ul->cq_head;
+	tail = __atomic_load_n(ul->cq_tail, __ATOMIC_ACQUIRE);
+
+	if (head == tail) {
+		n = receptor_uring_wait(ul->fd, ul->sq_pending, timer);
+		if (n == -1) {
+			if (errno == ETIME) {
+				receptor_event_wakeup(loop, 0);
+				return RECEPTOR_OK;
+			}
+
+			return (errno == EINTR) ? RECEPTOR_OK : RECEPTOR_ERROR;
+		}
+
+		ul->sq_pending -= (unsigned)n;
+	}
+	else if (receptor_uring_flush(ul) != RECEPTOR_OK) {
+		return RECEPTOR_ERROR;
+	}
+
+	tail = __atomic_load_n(ul->cq_tail, __ATOMIC_ACQUIRE);
+
+	receptor_event_wakeup(loop, tail - head);
+
+	for ( /* void */; head != tail; head++) {
+		cqe = &ul->cqes[head & *ul->cq_mask];
+		ud = cqe->user_data;
+
+		/*
+		 * 撤销请求的完成不需要分发 (POLL_REMOVE 为 0，ASYNC_CANCEL 为
+		 * RECEPTOR_URING_IO)。multishot accept/recv 会因 EOF 或出错自行结束，
+		 * 撤销排在其后时找不到请求是正常的；poll 不会自行结束，找不到即为失败。
+		 */
+		if (ud <= RECEPTOR_URING_TAGS) {
+			if (cqe->res < 0
+				&& !(ud == RECEPTOR_URING_IO && (cqe->res == -ENOENT || cqe->res == -EALREADY)))
+			{
+				receptor_atomic_store_relaxed(&loop->stats.cancel_failed, loop->stats.cancel_failed + 1);
+			}
+			continue;
+		}
+
+		ev = (receptor_event_t *)(receptor_event_untag(ud) & ~(uintptr_t)RECEPTOR_URING_TAGS);
+
+		/* 被撤销或已过期的请求：选中的缓冲区交还，已接受的连接关闭 */
+		if (cqe->res == -ECANCELED
+			|| !ev->active
+			|| receptor_event_tag_generation(ud) != ev->generation)
+		{
+			if (ul->br && (cqe->flags & IORING_CQE_F_BUFFER)) {
+				receptor_uring_buf_put(ul, &ul->bufs[cqe->flags >> IORING_CQE_BUFFER_SHIFT]);
+			}
+			else if ((ud & RECEPTOR_URING_IO) && ev->accept && cqe->res >= 0) {
+				close(cqe->res);
+			}
+			continue;
+		}
+
+		if ((ud & RECEPTOR_URING_IO) && ev->accept) {
+
+			if (cqe->res >= 0) {
+				if (!(cqe->flags & IORING_CQE_F_MORE)
+					&& receptor_uring_arm(ul, ev, ud & RECEPTOR_URING_TAGS) != RECEPTOR_OK)
+				{
+					ev->error = 1;
+				}
+
+				receptor_event_accept_socket(ev, cqe->res);
+				continue;
+			}
+
+			/*
+			 * 出错 (如 EMFILE) 时请求已终止：撤下事件，由监听的处理函数自己
+			 * accept，按错误退避或取完后重新注册。内核不支持时之后都用 poll。
+			 */
+			if (cqe->res == -EINVAL) {
+				ul->accept_multishot = 0;
+			}
+
+			ev->active = 0;
+			ev->armed = 0;
+			ev->ready = 1;
+			receptor_event_dispatch(loop, ev);
+			continue;
+		}
+
+		if (ud & RECEPTOR_URING_IO) {
+			if (cqe->res == -ENOBUFS) {
+				receptor_atomic_store_relaxed(&loop->stats.recv_nobufs, loop->stats.recv_nobufs + 1);
+			}
+
+			receptor_uring_recv_done(ul, ev, cqe);
+			ev->ready = 1;
+			receptor_event_dispatch(loop, ev);
+			continue;
+		}
+
+		/* oneshot 或被内核终止的 multishot，在分发前重新提交 */
+		if (!(cqe->flags & IORING_CQE_F_MORE)) {
+			if (receptor_uring_arm(ul, ev, ud & RECEPTOR_URING_TAGS) != RECEPTOR_OK) {
+				ev->error = 1;
+			}
+		}
+
+		if (cqe->res < 0) {
+			ev->error = 1;
+		}
+		else if (!(ud & RECEPTOR_URING_WRITE) && (cqe->res & POLLRDHUP)) {
+			ev->pending_eof = 1;
+		}
+
+		ev->ready = 1;
+		receptor_event_dispatch(loop, ev);
+	}
+
+	__atomic_store_n(ul->cq_head, head, __ATOMIC_RELEASE);
+
+	return RECEPTOR_OK;
+}
+
+static void
+receptor_uring_done(receptor_event_loop_t *loop)
+{
+	receptor_uring_loop_t *ul = loop->backend;
+
+	if (ul == NULL) {
+		return;
+	}
+
+	receptor_uring_unmap(ul);
+	loop->backend = NULL;
+}
+
+/* ==================== io_uring 事件操作结构 ==================== */
+
+static const receptor_event_actions_t receptor_uring_actions = {
+	receptor_uring_add_event,
+	receptor_uring_del_event,
+	receptor_uring_add_event,
+	receptor_uring_del_event,
+	receptor_uring_process_events,
+	receptor_uring_init,
+	receptor_uring_done,
+	NULL, /* notify */
+	receptor_uring_recv
+};
+
+/* ==================== io_uring 模块注册函数 ==================== */
+
+RECEPTOR_API void
+receptor_event_uring_register(void)
+{
+	receptor_event_set_actions(&receptor_uring_actions);
+}
+
+#endif /* __linux__ */
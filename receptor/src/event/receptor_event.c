@@ -1,5 +1,13 @@
 #include <receptor/def.h>
 #include <receptor_event.h>
+#include <receptor_event_timer.h>
+#include <receptor_event_posted.h>
+#include <receptor_event_notify.h>
+#include <receptor_event_metrics.h>
+#include <receptor_event_signal.h>
+#include <receptor_event_listen.h>
+#include <receptor_event_connection.h>
+#include <stdlib.h>
 
 /* ==================== 全局事件操作定义 ==================== */
 
@@ -11,25 +19,264 @@ receptor_event_actions_t receptor_event_actions = {
 	NULL, /* disable */
 	NULL, /* process_events */
 	NULL, /* init */
-	NULL  /* done */
+	NULL, /* done */
+	NULL, /* notify */
+	NULL  /* recv */
 };
 
+/* 兼容旧接口的进程默认循环 */
+static receptor_event_loop_t *receptor_event_loop_default = NULL;
+
+#define RECEPTOR_EVENT_LOOP_POOL_SIZE  16384
+
+/* ==================== 事件循环实现 ==================== */
+
+RECEPTOR_API receptor_event_loop_t *
+receptor_event_loop_create(void)
+{
+	receptor_pool_t        *pool;
+	receptor_event_loop_t  *loop;
+
+	if (receptor_event_actions.init == NULL) {
+		return NULL;
+	}
+
+	pool = receptor_create_pool(RECEPTOR_EVENT_LOOP_POOL_SIZE);
+	if (pool == NULL) {
+		return NULL;
+	}
+
+	loop = receptor_pcalloc(pool, sizeof(receptor_event_loop_t));
+	if (loop == NULL) {
+		receptor_destroy_pool(pool);
+		return NULL;
+	}
+
+	loop->actions = receptor_event_actions;
+	loop->pool = pool;
+	loop->cpu = -1;
+	loop->batch_min = RECEPTOR_EVENT_BATCH_MIN;
+	loop->batch_max = RECEPTOR_EVENT_BATCH_MAX;
+
+	receptor_event_timer_init(loop);
+	receptor_queue_init(&loop->posted_accept_events);
+	receptor_queue_init(&loop->posted_events);
+	receptor_queue_init(&loop->listening);
+
+	if (loop->actions.init(loop) != RECEPTOR_OK) {
+		receptor_destroy_pool(pool);
+		return NULL;
+	}
+
+	if (receptor_event_notify_init(loop) != RECEPTOR_OK) {
+		receptor_event_notify_done(loop);
+		loop->actions.done(loop);
+		receptor_destroy_pool(pool);
+		return NULL;
+	}
+
+	return loop;
+}
+
+RECEPTOR_API void
+receptor_event_loop_destroy(receptor_event_loop_t *loop)
+{
+	if (loop == NULL) {
+		return;
+	}
+
+	receptor_event_close_listening_sockets(loop);
+	receptor_event_signal_done(loop);
+	receptor_event_notify_done(loop);
+
+	if (loop->actions.done) {
+		loop->actions.done(loop);
+	}
+
+	free(loop->metrics);
+	receptor_event_connection_done(loop);
+	receptor_event_pool_done(loop);
+
+	receptor_destroy_pool(loop->pool);
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_add(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	if (loop->actions.add) {
+		return loop->actions.add(loop, ev, event, flags);
+	}
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_del(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	/* 连接即将关闭，已入队的事件不能再被处理 */
+	if ((flags & RECEPTOR_CLOSE_EVENT) && ev->posted) {
+		receptor_delete_posted_event(ev);
+	}
+
+	if (loop->actions.del) {
+		return loop->actions.del(loop, ev, event, flags);
+	}
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_enable(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	if (loop->actions.enable) {
+		return loop->actions.enable(loop, ev, event, flags);
+	}
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_disable(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	if (loop->actions.disable) {
+		return loop->actions.disable(loop, ev, event, flags);
+	}
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_process(receptor_event_loop_t *loop)
+{
+	return receptor_event_loop_process_timeout(loop, RECEPTOR_TIMER_INFINITE);
+}
+
+/*
+ * 等待时间取 timer 与最近定时器到期时间中较小者；上一轮有未处理完的
+ * 延迟事件时不等待。返回后依次处理 accept 事件、到期定时器和普通延迟事件。
+ */
+RECEPTOR_API receptor_int_t
+receptor_event_loop_process_timeout(receptor_event_loop_t *loop, receptor_msec_t timer)
+{
+	receptor_int_t      rc;
+	receptor_msec_t     delta;
+	uint64_t            start;
+
+	if (loop->actions.process_events == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	start = loop->metrics ? receptor_event_time_ns() : 0;
+
+	if (!receptor_queue_empty(&loop->posted_events)) {
+		timer = 0;
+	}
+	else {
+		delta = receptor_event_find_timer(loop);
+
+		if (timer == RECEPTOR_TIMER_INFINITE
+			|| (delta != RECEPTOR_TIMER_INFINITE && delta < timer))
+		{
+			timer = delta;
+		}
+	}
+
+	receptor_atomic_store_relaxed(&loop->stats.waits, loop->stats.waits + 1);
+
+	loop->wait_start = start;
+
+	rc = loop->actions.process_events(loop, timer);
+
+	receptor_event_time_update(loop);
+
+	receptor_event_process_posted(loop, &loop->posted_accept_events, 0);
+
+	receptor_event_expire_timers(loop);
+
+	receptor_event_process_posted(loop, &loop->posted_events, loop->posted_max);
+
+	if (loop->metrics) {
+		receptor_histogram_record(&loop->metrics->iteration, receptor_event_time_ns() - start);
+	}
+
+	return rc;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_run(receptor_event_loop_t *loop)
+{
+	while (!loop->stop) {
+		if (receptor_event_loop_process(loop) != RECEPTOR_OK) {
+			return RECEPTOR_ERROR;
+		}
+	}
+
+	return RECEPTOR_OK;
+}
+
+/* 可在其它线程调用，设置停止标志后唤醒循环使其立即退出 */
+RECEPTOR_API void
+receptor_event_loop_stop(receptor_event_loop_t *loop)
+{
+	loop->stop = 1;
+	receptor_event_loop_notify(loop);
+}
+
+RECEPTOR_API void
+receptor_event_loop_set_posted(receptor_event_loop_t *loop, receptor_uint_t on, receptor_uint_t max)
+{
+	loop->post_events = on;
+	loop->posted_max = max;
+}
+
+RECEPTOR_API void
+receptor_event_loop_set_busy_poll(receptor_event_loop_t *loop, receptor_uint_t usec)
+{
+	loop->busy_poll = usec;
+}
+
+/* 已分配的事件数组不会立即调整，下一次等待之后逐步收敛到新的范围 */
+RECEPTOR_API receptor_int_t
+receptor_event_loop_set_batch(receptor_event_loop_t *loop, receptor_uint_t min, receptor_uint_t max)
+{
+	if (min == 0 || min > max) {
+		return RECEPTOR_ERROR;
+	}
+
+	loop->batch_min = min;
+	loop->batch_max = max;
+
+	return RECEPTOR_OK;
+}
+
+RECEPTOR_API void
+receptor_event_loop_get_stats(receptor_event_loop_t *loop, receptor_event_loop_stats_t *stats)
+{
+	stats->waits = receptor_atomic_load_relaxed(&loop->stats.waits);
+	stats->events = receptor_atomic_load_relaxed(&loop->stats.events);
+	stats->batch = receptor_atomic_load_relaxed(&loop->stats.batch);
+	stats->cancel_failed = receptor_atomic_load_relaxed(&loop->stats.cancel_failed);
+	stats->recv_nobufs = receptor_atomic_load_relaxed(&loop->stats.recv_nobufs);
+}
+
 /* ==================== 事件API实现 ==================== */
 
 RECEPTOR_API receptor_int_t
 receptor_event_init(void)
 {
-	if (receptor_event_actions.init) {
-		return receptor_event_actions.init();
+	if (receptor_event_loop_default) {
+		return RECEPTOR_OK;
 	}
-	return RECEPTOR_ERROR;
+
+	receptor_event_loop_default = receptor_event_loop_create();
+	if (receptor_event_loop_default == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
 }
 
 RECEPTOR_API receptor_int_t
 receptor_event_add(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
 {
-	if (receptor_event_actions.add) {
-		return receptor_event_actions.add(ev, event, flags);
+	if (receptor_event_loop_default) {
+		return receptor_event_loop_add(receptor_event_loop_default, ev, event, flags);
 	}
 	return RECEPTOR_ERROR;
 }
@@ -37,8 +284,26 @@ receptor_event_add(receptor_event_t *ev, receptor_int_t event, receptor_uint_t f
 RECEPTOR_API receptor_int_t
 receptor_event_del(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
 {
-	if (receptor_event_actions.del) {
-		return receptor_event_actions.del(ev, event, flags);
+	if (receptor_event_loop_default) {
+		return receptor_event_loop_del(receptor_event_loop_default, ev, event, flags);
+	}
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_enable(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	if (receptor_event_loop_default) {
+		return receptor_event_loop_enable(receptor_event_loop_default, ev, event, flags);
+	}
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_disable(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags)
+{
+	if (receptor_event_loop_default) {
+		return receptor_event_loop_disable(receptor_event_loop_default, ev, event, flags);
 	}
 	return RECEPTOR_ERROR;
 }
@@ -46,8 +311,8 @@ receptor_event_del(receptor_event_t *ev, receptor_int_t event, receptor_uint_t f
 RECEPTOR_API receptor_int_t
 receptor_event_process(void)
 {
-	if (receptor_event_actions.process_events) {
-		return receptor_event_actions.process_events();
+	if (receptor_event_loop_default) {
+		return receptor_event_loop_process(receptor_event_loop_default);
 	}
 	return RECEPTOR_ERROR;
 }
@@ -55,11 +320,18 @@ receptor_event_process(void)
 RECEPTOR_API void
 receptor_event_done(void)
 {
-	if (receptor_event_actions.done) {
-		receptor_event_actions.done();
+	if (receptor_event_loop_default) {
+		receptor_event_loop_destroy(receptor_event_loop_default);
+		receptor_event_loop_default = NULL;
 	}
 }
 
+RECEPTOR_API receptor_event_loop_t *
+receptor_event_default_loop(void)
+{
+	return receptor_event_loop_default;
+}
+
 /* ==================== 事件操作设置函数 ==================== */
 
 RECEPTOR_API void
@@ -68,4 +340,4 @@ receptor_event_set_actions(const receptor_event_actions_t *actions)
 	if (actions) {
 		receptor_event_actions = *actions;
 	}
-}
\ No newline at end of file
+}
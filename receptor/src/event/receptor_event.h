@@ -2,6 +2,9 @@
 #define _RECEPTOR_EVENT_H_
 
 #include <receptor/def.h>
+#include <receptor_palloc.h>
+#include <receptor_queue.h>
+#include <receptor_histogram.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,40 +13,290 @@ extern "C" {
 	/* ==================== 事件结构定义 ==================== */
 
 	typedef struct receptor_event_s       receptor_event_t;
+	typedef struct receptor_connection_s  receptor_connection_t;
+	typedef struct receptor_event_loop_s  receptor_event_loop_t;
+	typedef struct receptor_event_loop_group_s  receptor_event_loop_group_t;
 	typedef void(*receptor_event_handler_pt)(receptor_event_t *ev);
+	typedef void(*receptor_event_signal_pt)(int signo);
 
+	/* add/del 的 event 参数 */
+#define RECEPTOR_READ_EVENT     1
+#define RECEPTOR_WRITE_EVENT    2
+
+	/* add/del 的 flags 参数 */
+#define RECEPTOR_LEVEL_EVENT    0x00    /* 水平触发 */
+#define RECEPTOR_CLEAR_EVENT    0x01    /* 边沿触发 (EPOLLET) */
+#define RECEPTOR_CLOSE_EVENT    0x02    /* 描述符即将关闭，无需通知内核 */
+#define RECEPTOR_RECV_EVENT     0x04    /* 与 CLEAR 同用于读事件：后端可预先收取数据 (io_uring multishot recv)，
+                                           处理函数须用 receptor_event_recv 读取 */
+
+	/* process_events 的 timer 参数，单位毫秒 */
+#define RECEPTOR_TIMER_INFINITE ((receptor_msec_t) -1)
+
+	/*
+	 * 分发路径用到的字段集中在一起：64 位 Unix 下正好 64 字节，
+	 * 连接表中的事件按缓存行对齐，分发一个事件只触及一条缓存行。
+	 * 描述符与所属连接的 fd 相同，后端注册时不必再访问连接。
+	 */
 	struct receptor_event_s {
-		void                    *data;
+		void                    *data;      /* 所属连接 receptor_connection_t */
 		receptor_event_handler_pt   handler;
-		receptor_uint_t         write : 1;
-		receptor_uint_t         active : 1;
-		receptor_uint_t         ready : 1;
+		receptor_socket_t        fd;
+		uint32_t                 write : 1;
+		uint32_t                 active : 1;
+		uint32_t                 ready : 1;
+		uint32_t                 eof : 1;
+		uint32_t                 pending_eof : 1;  /* 对端已关闭写端 (EPOLLRDHUP) */
+		uint32_t                 error : 1;
+		uint32_t                 timer_set : 1;
+		uint32_t                 timedout : 1;
+		uint32_t                 posted : 1;
+		uint32_t                 accept : 1;   /* 监听描述符的读事件，优先处理 */
+		uint32_t                 armed : 4;    /* 后端已提交的请求 (io_uring user_data 低位标记)，撤销时据此重建 */
+		uint32_t                 generation : 16;  /* 连接每次复用加一，识别过期的就绪通知 */
+		receptor_queue_t         timer;      /* 时间轮槽位链表节点 */
+		receptor_msec_t          timer_expires;
+		receptor_queue_t         queue;      /* 延迟事件队列节点 */
+	};
+
+	/* 每个描述符一个连接，读写事件分开注册和分发 */
+	struct receptor_connection_s {
+		void                    *data;
+		receptor_event_t        *read;
+		receptor_event_t        *write;
+		receptor_socket_t        fd;
+		receptor_uint_t          index;     /* 在 poll/select 后端数组中的下标 */
+		void                    *recv_buf;  /* 后端已收到、尚未读走的数据，由后端管理 (io_uring) */
 	};
 
+	/* 设置连接的描述符，同时写入两个事件 */
+#define receptor_connection_set_fd(c, s)                                      \
+    (c)->fd = (s);                                                            \
+    (c)->read->fd = (s);                                                      \
+    (c)->write->fd = (s)
+
+	/*
+	 * 后端交给内核的 64 位用户数据：低位是指针，高 16 位是事件的代数
+	 * (用户态地址不超过 48 位)。取回时代数不符说明连接已被回收复用。
+	 */
+#define RECEPTOR_EVENT_TAG_SHIFT    48
+
+#define receptor_event_tag(p, gen)                                            \
+    ((uint64_t) (uintptr_t) (p) | ((uint64_t) (gen) << RECEPTOR_EVENT_TAG_SHIFT))
+
+#define receptor_event_untag(u)                                               \
+    ((uintptr_t) ((u) & (((uint64_t) 1 << RECEPTOR_EVENT_TAG_SHIFT) - 1)))
+
+#define receptor_event_tag_generation(u)                                      \
+    ((uint32_t) ((u) >> RECEPTOR_EVENT_TAG_SHIFT))
+
+	/* 连接表中的一项，读写事件各占一条缓存行，连接紧随其后 */
+	typedef struct {
+		RECEPTOR_CACHELINE_ALIGNED receptor_event_t read;
+		receptor_event_t        write;
+		receptor_connection_t   c;
+	} receptor_connection_slot_t;
+
 	/* ==================== 事件操作接口 ==================== */
 
 	typedef struct {
-		receptor_int_t(*add)(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
-		receptor_int_t(*del)(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
-		receptor_int_t(*enable)(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
-		receptor_int_t(*disable)(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
-		receptor_int_t(*process_events)(void);
-		receptor_int_t(*init)(void);
-		void(*done)(void);
+		receptor_int_t(*add)(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+		receptor_int_t(*del)(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+		receptor_int_t(*enable)(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+		receptor_int_t(*disable)(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+		receptor_int_t(*process_events)(receptor_event_loop_t *loop, receptor_msec_t timer);
+		receptor_int_t(*init)(receptor_event_loop_t *loop);
+		void(*done)(receptor_event_loop_t *loop);
+		/* 可选，后端自带唤醒机制时提供 (IOCP)，为 NULL 时使用 eventfd/管道 */
+		receptor_int_t(*notify)(receptor_event_loop_t *loop);
+		/* 可选，后端预先收取数据时提供 (io_uring)，为 NULL 时 receptor_event_recv 直接调用 recv() */
+		receptor_int_t(*recv)(receptor_event_loop_t *loop, receptor_connection_t *c, void *buf, size_t size);
 	} receptor_event_actions_t;
 
+	/* ==================== 跨线程任务 ==================== */
+
+	typedef struct receptor_event_task_s  receptor_event_task_t;
+	typedef void(*receptor_event_task_pt)(receptor_event_task_t *task);
+
+	/* 任务结构由投递方分配，在循环线程上执行 handler 之后才可释放或复用 */
+	struct receptor_event_task_s {
+		receptor_event_task_t   *next;
+		receptor_event_task_pt   handler;
+		void                    *data;
+	};
+
+	/* ==================== 分层时间轮 ==================== */
+
+	/*
+	 * 第 0 层 256 个槽，每槽 1ms；其余三层各 64 个槽，
+	 * 粒度依次为 256ms、16.4s、17.5min，总跨度约 18.6 小时，
+	 * 更远的定时器先放在最高层，级联时重新计算位置。
+	 */
+#define RECEPTOR_TIMER_WHEEL_BITS0  8
+#define RECEPTOR_TIMER_WHEEL_BITSN  6
+#define RECEPTOR_TIMER_WHEEL_SIZE0  (1 << RECEPTOR_TIMER_WHEEL_BITS0)
+#define RECEPTOR_TIMER_WHEEL_SIZEN  (1 << RECEPTOR_TIMER_WHEEL_BITSN)
+#define RECEPTOR_TIMER_WHEEL_LEVELS 4
+
+	typedef struct {
+		receptor_queue_t        slot0[RECEPTOR_TIMER_WHEEL_SIZE0];
+		receptor_queue_t        slotn[RECEPTOR_TIMER_WHEEL_LEVELS - 1][RECEPTOR_TIMER_WHEEL_SIZEN];
+		uint64_t                bitmap0[RECEPTOR_TIMER_WHEEL_SIZE0 / 64];  /* 非空槽位，延迟清除 */
+		uint64_t                bitmap1;
+		receptor_msec_t         now;        /* 下一个待处理的刻度 */
+		receptor_uint_t         count;
+	} receptor_event_timer_wheel_t;
+
+	/* ==================== 事件循环 ==================== */
+
+	/* 一次等待最多取回的事件数的默认上下限，可用 receptor_event_loop_set_batch 修改 */
+#define RECEPTOR_EVENT_BATCH_MIN    64
+#define RECEPTOR_EVENT_BATCH_MAX    4096
+
+	/* 每个循环缓存的空闲池个数，见 receptor_event_get_pool */
+#define RECEPTOR_EVENT_POOL_CACHE   32
+
+	/*
+	 * 只由循环线程写入，其它线程可无锁读取；
+	 * events / waits 即每次系统调用摊到的事件数。
+	 */
+	typedef struct {
+		uint64_t                waits;      /* 调用后端等待的次数 */
+		uint64_t                events;     /* 取回的就绪事件总数 */
+		uint64_t                batch;      /* 当前一次最多取回的事件数 */
+		uint64_t                cancel_failed;  /* 撤销已提交的请求时内核未找到它的次数 (io_uring) */
+		uint64_t                recv_nobufs;    /* 提供缓冲区用完、multishot recv 终止的次数 (io_uring) */
+	} receptor_event_loop_stats_t;
+
+	/* 开启埋点后记录的分布，时间单位为纳秒 */
+	typedef struct {
+		receptor_histogram_t    iteration;  /* 一轮循环的总耗时 */
+		receptor_histogram_t    handler;    /* 单个处理函数的耗时 */
+		receptor_histogram_t    events;     /* 每次唤醒取回的事件数 */
+		receptor_histogram_t    blocked;    /* 阻塞在内核等待中的时间 */
+	} receptor_event_loop_metrics_t;
+
+	/*
+	 * 事件循环持有自己的后端状态，一个线程一个循环，分发路径上无需加锁。
+	 * actions 在创建时从当前注册的模块复制，之后切换模块不影响已有循环。
+	 */
+	struct receptor_event_loop_s {
+		receptor_event_actions_t    actions;
+		void                       *backend;   /* 后端私有状态 */
+		receptor_pool_t            *pool;
+		receptor_uint_t             index;     /* 在循环组中的序号 */
+		receptor_int_t              cpu;       /* 绑定的 CPU，-1 表示不绑定 */
+		volatile receptor_uint_t    stop;
+		receptor_event_loop_group_t *group;
+		receptor_msec_t             current_msec;  /* 单调时钟，每次醒来更新 */
+		receptor_event_timer_wheel_t timers;
+		receptor_uint_t             batch_min;
+		receptor_uint_t             batch_max;
+		receptor_event_loop_stats_t stats;
+		receptor_event_loop_metrics_t *metrics;   /* NULL 表示未开启埋点 */
+		uint64_t                    wait_start;    /* 本次等待开始的时刻 */
+		receptor_uint_t             busy_poll;     /* 阻塞前忙轮询的微秒数，0 不轮询 (epoll) */
+		receptor_queue_t            listening;     /* 本循环打开的监听套接字 */
+		receptor_connection_slot_t *connections;   /* 预分配的连接表，NULL 表示未初始化 */
+		receptor_connection_t      *free_connections;  /* 空闲链表，以 data 串接 */
+		receptor_uint_t             connection_n;
+		receptor_uint_t             free_connection_n;
+		receptor_pool_t            *free_pools[RECEPTOR_EVENT_POOL_CACHE];  /* 已重置的空闲池 */
+		receptor_uint_t             free_pool_n;
+		receptor_uint_t             pool_arena;    /* get_pool 新建的池从大页区域取块 */
+		receptor_uint_t             post_events;   /* 非零时就绪事件先入队，再统一处理 */
+		receptor_uint_t             posted_max;    /* 每轮处理的普通延迟事件上限，0 不限 */
+		receptor_queue_t            posted_accept_events;
+		receptor_queue_t            posted_events;
+		receptor_connection_t      *notify;        /* 唤醒通道，读端注册在本循环中 */
+		receptor_socket_t           notify_fd;     /* 写端，eventfd 时与读端相同 */
+		receptor_event_task_t *volatile tasks;     /* 其它线程投递的任务，后进先出栈 */
+		void                       *data;
+	};
+
+	typedef void(*receptor_event_loop_init_pt)(receptor_event_loop_t *loop);
+
 	/* ==================== 全局事件操作声明 ==================== */
 
-	/* 使用 extern 声明，在事件模块中定义 */
+	/* 当前注册的事件模块，新建的循环以它为模板 */
 	extern RECEPTOR_API receptor_event_actions_t receptor_event_actions;
 
+	/* ==================== 事件循环API ==================== */
+
+	RECEPTOR_API receptor_event_loop_t *receptor_event_loop_create(void);
+	RECEPTOR_API void receptor_event_loop_destroy(receptor_event_loop_t *loop);
+	RECEPTOR_API receptor_int_t receptor_event_loop_add(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+	RECEPTOR_API receptor_int_t receptor_event_loop_del(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+	RECEPTOR_API receptor_int_t receptor_event_loop_enable(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+	RECEPTOR_API receptor_int_t receptor_event_loop_disable(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+	RECEPTOR_API receptor_int_t receptor_event_loop_process(receptor_event_loop_t *loop);
+	RECEPTOR_API receptor_int_t receptor_event_loop_process_timeout(receptor_event_loop_t *loop, receptor_msec_t timer);
+	RECEPTOR_API receptor_int_t receptor_event_loop_run(receptor_event_loop_t *loop);
+	RECEPTOR_API void receptor_event_loop_stop(receptor_event_loop_t *loop);
+
+	/*
+	 * 以下两个接口可在任意线程调用：notify 唤醒阻塞在等待中的循环；
+	 * post_task 把任务压入无锁队列，循环被唤醒后按投递顺序执行。
+	 */
+	RECEPTOR_API receptor_int_t receptor_event_loop_notify(receptor_event_loop_t *loop);
+	RECEPTOR_API receptor_int_t receptor_event_loop_post_task(receptor_event_loop_t *loop, receptor_event_task_t *task);
+
+	/*
+	 * 开启延迟处理：新连接先于其它 I/O 处理，每轮至多处理 max 个
+	 * 普通事件 (0 不限)，突发建连与大量 I/O 同时到来时限制单轮耗时。
+	 */
+	RECEPTOR_API void receptor_event_loop_set_posted(receptor_event_loop_t *loop, receptor_uint_t on, receptor_uint_t max);
+
+	/* 后端按负载在 [min, max] 内调整一次等待取回的事件数 (epoll) */
+	RECEPTOR_API receptor_int_t receptor_event_loop_set_batch(receptor_event_loop_t *loop, receptor_uint_t min, receptor_uint_t max);
+	RECEPTOR_API void receptor_event_loop_get_stats(receptor_event_loop_t *loop, receptor_event_loop_stats_t *stats);
+
+	/*
+	 * 信号以普通读事件的形式在循环线程上递送 (Linux 用 signalfd，其它 Unix 用自管道)，
+	 * handler 中可以安全地调用任何接口。信号是进程级的，只能注册到同一个循环。
+	 * Windows 下不支持，返回 RECEPTOR_ERROR。
+	 */
+	RECEPTOR_API receptor_int_t receptor_event_loop_add_signal(receptor_event_loop_t *loop, int signo, receptor_event_signal_pt handler);
+
+	/*
+	 * 忙轮询：等待前先以零超时轮询 usec 微秒，用一个核的 CPU 换取更低的唤醒延迟。
+	 * 目前只有 epoll 后端支持，0 表示关闭。
+	 */
+	RECEPTOR_API void receptor_event_loop_set_busy_poll(receptor_event_loop_t *loop, receptor_uint_t usec);
+
+	/*
+	 * 开启埋点：记录循环耗时、处理函数耗时、每次唤醒的事件数和阻塞时间。
+	 * get_metrics 可在任意线程调用，未开启时返回 NULL，
+	 * 用 receptor_histogram_percentile 等接口读取。
+	 */
+	RECEPTOR_API receptor_int_t receptor_event_loop_enable_metrics(receptor_event_loop_t *loop);
+	RECEPTOR_API const receptor_event_loop_metrics_t *receptor_event_loop_get_metrics(receptor_event_loop_t *loop);
+
+	/* ==================== 多线程循环组 ==================== */
+
+	/*
+	 * 创建 n 个循环，每个循环在独立线程上运行；pin 非零时
+	 * 第 i 个线程绑定到第 i % ncpu 个 CPU。init 在循环线程上、
+	 * 进入 run 之前调用，用于注册监听等线程私有的事件。
+	 */
+	RECEPTOR_API receptor_event_loop_group_t *receptor_event_loop_group_create(receptor_uint_t n, receptor_uint_t pin);
+	RECEPTOR_API receptor_int_t receptor_event_loop_group_start(receptor_event_loop_group_t *group, receptor_event_loop_init_pt init);
+	RECEPTOR_API void receptor_event_loop_group_stop(receptor_event_loop_group_t *group);
+	RECEPTOR_API void receptor_event_loop_group_destroy(receptor_event_loop_group_t *group);
+	RECEPTOR_API receptor_uint_t receptor_event_loop_group_size(receptor_event_loop_group_t *group);
+	RECEPTOR_API receptor_event_loop_t *receptor_event_loop_group_get(receptor_event_loop_group_t *group, receptor_uint_t i);
+
 	/* ==================== 事件API函数 ==================== */
 
+	/* 以下接口作用于进程默认循环，由 receptor_event_init 创建 */
 	RECEPTOR_API receptor_int_t receptor_event_init(void);
 	RECEPTOR_API receptor_int_t receptor_event_add(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
 	RECEPTOR_API receptor_int_t receptor_event_del(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+	RECEPTOR_API receptor_int_t receptor_event_enable(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
+	RECEPTOR_API receptor_int_t receptor_event_disable(receptor_event_t *ev, receptor_int_t event, receptor_uint_t flags);
 	RECEPTOR_API receptor_int_t receptor_event_process(void);
 	RECEPTOR_API void receptor_event_done(void);
+	RECEPTOR_API receptor_event_loop_t *receptor_event_default_loop(void);
 
 	/* ==================== 事件操作设置函数 ==================== */
 
@@ -59,6 +312,21 @@ extern "C" {
 	/* Linux epoll 模块注册 */
 #ifdef __linux__
 	RECEPTOR_API void receptor_event_epoll_register(void);
+
+	/*
+	 * Linux io_uring 模块注册，内核不支持时自动退回 epoll。
+	 * 监听套接字使用 multishot accept，以 RECEPTOR_RECV_EVENT 注册的读事件
+	 * 使用 multishot recv 收到提供缓冲区环中；内核缺少这两项时退回 poll。
+	 */
+	RECEPTOR_API void receptor_event_uring_register(void);
+
+	/* 设置套接字的 SO_BUSY_POLL，可与 receptor_event_loop_set_busy_poll 配合使用 */
+	RECEPTOR_API receptor_int_t receptor_event_socket_busy_poll(receptor_socket_t s, receptor_uint_t usec);
+#endif
+
+	/* Unix poll 模块注册 */
+#ifndef _WIN32
+	RECEPTOR_API void receptor_event_poll_register(void);
 #endif
 
 	/* 跨平台 select 模块注册 */
@@ -0,0 +1,236 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_timer.h>
+#include <receptor_event_posted.h>
+#include <receptor_event_connection.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/* ==================== 连接表实现 ==================== */
+
+/* 64 位 Unix 下事件正好占一条缓存行，布局改动时在这里报错 */
+#if !defined(_WIN32) && (UINTPTR_MAX == UINT64_MAX)
+typedef char receptor_event_size_check[(sizeof(receptor_event_t) == RECEPTOR_CACHELINE_SIZE) ? 1 : -1];
+#endif
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_init_connections(receptor_event_loop_t *loop, receptor_uint_t n)
+{
+	receptor_uint_t              i;
+	receptor_connection_t       *c, *next;
+	receptor_connection_slot_t  *slots;
+
+	if (loop->connections != NULL || n == 0) {
+		return RECEPTOR_ERROR;
+	}
+
+	/* 连接表可能很大，不放在循环的内存池中；按缓存行对齐分配 */
+#ifdef _WIN32
+	slots = _aligned_malloc(n * sizeof(receptor_connection_slot_t), RECEPTOR_CACHELINE_SIZE);
+	if (slots == NULL) {
+		return RECEPTOR_ERROR;
+	}
+#else
+	if (posix_memalign((void **)&slots, RECEPTOR_CACHELINE_SIZE, n * sizeof(receptor_connection_slot_t)) != 0) {
+		return RECEPTOR_ERROR;
+	}
+#endif
+
+	memset(slots, 0, n * sizeof(receptor_connection_slot_t));
+
+	/* 按下标顺序串成空闲链表，先取出的连接在内存中相邻 */
+	next = NULL;
+	i = n;
+
+	do {
+		i--;
+
+		c = &slots[i].c;
+		c->data = next;
+		c->read = &slots[i].read;
+		c->write = &slots[i].write;
+		receptor_connection_set_fd(c, RECEPTOR_INVALID_SOCKET);
+
+		next = c;
+	} while (i);
+
+	loop->connections = slots;
+	loop->free_connections = next;
+	loop->connection_n = n;
+	loop->free_connection_n = n;
+
+	return RECEPTOR_OK;
+}
+
+RECEPTOR_API void
+receptor_event_connection_done(receptor_event_loop_t *loop)
+{
+	if (loop->connections == NULL) {
+		return;
+	}
+
+#ifdef _WIN32
+	_aligned_free(loop->connections);
+#else
+	free(loop->connections);
+#endif
+
+	loop->connections = NULL;
+	loop->free_connections = NULL;
+	loop->connection_n = 0;
+	loop->free_connection_n = 0;
+}
+
+RECEPTOR_API receptor_connection_t *
+receptor_event_get_connection(receptor_event_loop_t *loop, receptor_socket_t s)
+{
+	uint32_t                generation;
+	receptor_event_t       *rev, *wev;
+	receptor_connection_t  *c;
+
+	c = loop->free_connections;
+	if (c == NULL) {
+		return NULL;
+	}
+
+	loop->free_connections = c->data;
+	loop->free_connection_n--;
+
+	rev = c->read;
+	wev = c->write;
+
+	/* 代数跨越复用保留并加一，旧连接残留在后端的通知据此丢弃 */
+	generation = rev->generation + 1;
+
+	memset(rev, 0, sizeof(receptor_event_t));
+	memset(wev, 0, sizeof(receptor_event_t));
+
+	rev->data = c;
+	rev->generation = generation;
+	wev->data = c;
+	wev->write = 1;
+	wev->generation = generation;
+
+	c->data = NULL;
+	c->recv_buf = NULL;
+	receptor_connection_set_fd(c, s);
+
+	return c;
+}
+
+RECEPTOR_API void
+receptor_event_free_connection(receptor_event_loop_t *loop, receptor_connection_t *c)
+{
+	c->data = loop->free_connections;
+	receptor_connection_set_fd(c, RECEPTOR_INVALID_SOCKET);
+
+	loop->free_connections = c;
+	loop->free_connection_n++;
+}
+
+RECEPTOR_API void
+receptor_event_close_connection(receptor_event_loop_t *loop, receptor_connection_t *c)
+{
+	receptor_socket_t s;
+
+	if (c->read->timer_set) {
+		receptor_event_del_timer(loop, c->read);
+	}
+
+	if (c->write->timer_set) {
+		receptor_event_del_timer(loop, c->write);
+	}
+
+	if (c->read->posted) {
+		receptor_delete_posted_event(c->read);
+	}
+
+	if (c->write->posted) {
+		receptor_delete_posted_event(c->write);
+	}
+
+	if (c->read->active) {
+		receptor_event_loop_del(loop, c->read, RECEPTOR_READ_EVENT, RECEPTOR_CLOSE_EVENT);
+	}
+
+	if (c->write->active) {
+		receptor_event_loop_del(loop, c->write, RECEPTOR_WRITE_EVENT, RECEPTOR_CLOSE_EVENT);
+	}
+
+	s = c->fd;
+
+	receptor_event_free_connection(loop, c);
+
+	if (s == RECEPTOR_INVALID_SOCKET) {
+		return;
+	}
+
+#ifdef _WIN32
+	closesocket(s);
+#else
+	close(s);
+#endif
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_recv(receptor_event_loop_t *loop, receptor_connection_t *c, void *buf, size_t size)
+{
+	if (loop->actions.recv) {
+		return loop->actions.recv(loop, c, buf, size);
+	}
+
+#ifdef _WIN32
+	return recv(c->fd, buf, (int)size, 0);
+#else
+	return recv(c->fd, buf, size, 0);
+#endif
+}
+
+/* ==================== 空闲池缓存实现 ==================== */
+
+RECEPTOR_API receptor_pool_t *
+receptor_event_get_pool(receptor_event_loop_t *loop)
+{
+	if (loop->free_pool_n) {
+		return loop->free_pools[--loop->free_pool_n];
+	}
+
+	if (loop->pool_arena) {
+		return receptor_create_pool_arena();
+	}
+
+	return receptor_create_pool(RECEPTOR_DEFAULT_POOL_SIZE);
+}
+
+RECEPTOR_API void
+receptor_event_free_pool(receptor_event_loop_t *loop, receptor_pool_t *pool)
+{
+	if (loop->free_pool_n == RECEPTOR_EVENT_POOL_CACHE) {
+		receptor_destroy_pool(pool);
+		return;
+	}
+
+	receptor_reset_pool(pool);
+	loop->free_pools[loop->free_pool_n++] = pool;
+}
+
+RECEPTOR_API void
+receptor_event_loop_set_pool_arena(receptor_event_loop_t *loop, receptor_uint_t on)
+{
+	loop->pool_arena = on ? 1 : 0;
+}
+
+RECEPTOR_API void
+receptor_event_pool_done(receptor_event_loop_t *loop)
+{
+	while (loop->free_pool_n) {
+		receptor_destroy_pool(loop->free_pools[--loop->free_pool_n]);
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef _RECEPTOR_EVENT_CONNECTION_H_
+#define _RECEPTOR_EVENT_CONNECTION_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 连接表 ==================== */
+
+	/*
+	 * 每个循环一张连接表，大小取自 worker_connections，一次性分配，
+	 * 每项的读写事件紧挨着连接存放。取出和归还都是空闲链表上的 O(1) 操作，
+	 * accept 路径上不再分配内存。连接表只能在所属循环的线程上使用。
+	 */
+	RECEPTOR_API receptor_int_t receptor_event_loop_init_connections(receptor_event_loop_t *loop, receptor_uint_t n);
+
+	/* 释放连接表，销毁循环时自动调用 */
+	RECEPTOR_API void receptor_event_connection_done(receptor_event_loop_t *loop);
+
+	/* 取出一个空闲连接并清零其读写事件，连接表用完时返回 NULL */
+	RECEPTOR_API receptor_connection_t *receptor_event_get_connection(receptor_event_loop_t *loop, receptor_socket_t s);
+
+	/* 归还连接，调用方须已删除其定时器和事件 */
+	RECEPTOR_API void receptor_event_free_connection(receptor_event_loop_t *loop, receptor_connection_t *c);
+
+	/* 删除定时器、延迟事件和已注册的事件，关闭描述符并归还连接 */
+	RECEPTOR_API void receptor_event_close_connection(receptor_event_loop_t *loop, receptor_connection_t *c);
+
+	/*
+	 * 从连接读取数据，语义同 recv()：返回读到的字节数，0 表示对端关闭，
+	 * -1 时 errno 为 EAGAIN 表示暂无数据。以 RECEPTOR_RECV_EVENT 注册的连接
+	 * 在 io_uring 下数据已由内核收到缓冲区中，这里只做拷贝，不产生系统调用。
+	 */
+	RECEPTOR_API receptor_int_t receptor_event_recv(receptor_event_loop_t *loop, receptor_connection_t *c, void *buf, size_t size);
+
+	/* ==================== 空闲池缓存 ==================== */
+
+	/*
+	 * 连接和请求用的内存池。get_pool 优先取本循环缓存的空闲池，
+	 * free_pool 重置后放回缓存，缓存满时才销毁；长连接上逐个请求
+	 * 取还池不再调用 posix_memalign / free。只能在所属循环的线程上使用。
+	 */
+	RECEPTOR_API receptor_pool_t *receptor_event_get_pool(receptor_event_loop_t *loop);
+	RECEPTOR_API void receptor_event_free_pool(receptor_event_loop_t *loop, receptor_pool_t *pool);
+
+	/*
+	 * 之后 get_pool 新建的池以 receptor_create_pool_arena 创建，块来自循环线程的
+	 * 大页区域并靠近线程所在的 NUMA 节点。适合绑定了 CPU 的循环组。
+	 */
+	RECEPTOR_API void receptor_event_loop_set_pool_arena(receptor_event_loop_t *loop, receptor_uint_t on);
+
+	/* 销毁缓存的空闲池，销毁循环时自动调用 */
+	RECEPTOR_API void receptor_event_pool_done(receptor_event_loop_t *loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_CONNECTION_H_ */
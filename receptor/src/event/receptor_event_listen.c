@@ -0,0 +1,340 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_listen.h>
+#include <receptor_event_timer.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/tcp.h>
+#endif
+
+#if defined(RECEPTOR_HAVE_ACCEPT4) || defined(__linux__)
+#define RECEPTOR_EVENT_ACCEPT4  1
+#endif
+
+/* ==================== 监听套接字实现 ==================== */
+
+#ifdef _WIN32
+#define receptor_close_socket   closesocket
+#else
+#define receptor_close_socket   close
+#endif
+
+static receptor_int_t
+receptor_event_socket_nonblocking(receptor_socket_t s)
+{
+#ifdef _WIN32
+	u_long nb = 1;
+
+	return (ioctlsocket(s, FIONBIO, &nb) == 0) ? RECEPTOR_OK : RECEPTOR_ERROR;
+#else
+	int flags;
+
+	flags = fcntl(s, F_GETFL);
+	if (flags == -1 || fcntl(s, F_SETFL, flags | O_NONBLOCK) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	return (fcntl(s, F_SETFD, FD_CLOEXEC) == -1) ? RECEPTOR_ERROR : RECEPTOR_OK;
+#endif
+}
+
+/*
+ * 一次就绪最多接受 accept_budget 个连接，避免突发建连时一个连接
+ * 一次 epoll_wait 往返；监听事件为水平触发，超出预算的连接留到下一轮，
+ * 不会让已有连接的 I/O 饿死。
+ * 描述符耗尽时 backlog 里的连接一直可读，水平触发会让循环空转，
+ * 此时先把监听事件摘掉，RECEPTOR_EVENT_ACCEPT_DELAY 毫秒后由定时器
+ * 重新加入 (定时器到期同样调用本函数，ev->timedout 置位)。
+ * io_uring 的 multishot accept 出错时请求已终止，后端撤下事件后调用本函数，
+ * 由这里自己 accept，取完后重新注册。
+ */
+static void
+receptor_event_accept(receptor_event_t *ev)
+{
+	receptor_uint_t         n;
+	receptor_socket_t       s;
+	receptor_connection_t  *c = ev->data;
+	receptor_listening_t   *ls = c->data;
+
+	if (ev->timedout) {
+		ev->timedout = 0;
+
+		if (receptor_event_loop_add(ls->loop, ev, RECEPTOR_READ_EVENT, RECEPTOR_LEVEL_EVENT) != RECEPTOR_OK) {
+			return;
+		}
+	}
+
+	for (n = 0; n < ls->accept_budget; n++) {
+
+#ifdef RECEPTOR_EVENT_ACCEPT4
+		s = accept4(c->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+		s = accept(c->fd, NULL, NULL);
+#endif
+
+		if (s == RECEPTOR_INVALID_SOCKET) {
+#ifndef _WIN32
+			/* 连接在 accept 前被对端重置，继续取下一个 */
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+#endif
+#ifdef _WIN32
+			if (WSAGetLastError() == WSAEMFILE || WSAGetLastError() == WSAENOBUFS) {
+#else
+			if (errno == EMFILE || errno == ENFILE) {
+#endif
+				/* 描述符耗尽，暂停接受，等连接释放描述符后再试 */
+				if (receptor_event_loop_del(ls->loop, ev, RECEPTOR_READ_EVENT, 0) == RECEPTOR_OK) {
+					receptor_event_add_timer(ls->loop, ev, RECEPTOR_EVENT_ACCEPT_DELAY);
+				}
+
+				return;
+			}
+
+			/* EAGAIN 表示已取完，其它错误留到下一轮再试 */
+			break;
+		}
+
+#ifndef RECEPTOR_EVENT_ACCEPT4
+		if (receptor_event_socket_nonblocking(s) != RECEPTOR_OK) {
+			receptor_close_socket(s);
+			continue;
+		}
+#endif
+
+		if (ls->handler == NULL) {
+			receptor_close_socket(s);
+			continue;
+		}
+
+		ls->handler(ls, s);
+
+		/* 处理函数可能关闭了监听套接字 */
+		if (!ls->open) {
+			return;
+		}
+	}
+
+	if (!ev->active) {
+		(void)receptor_event_loop_add(ls->loop, ev, RECEPTOR_READ_EVENT, RECEPTOR_LEVEL_EVENT);
+	}
+}
+
+/* 后端以完成方式 (io_uring multishot accept) 接受的连接，描述符已是非阻塞 */
+RECEPTOR_API void
+receptor_event_accept_socket(receptor_event_t *ev, receptor_socket_t s)
+{
+	receptor_connection_t  *c = ev->data;
+	receptor_listening_t   *ls = c->data;
+
+	if (ls->handler == NULL || !ls->open) {
+		receptor_close_socket(s);
+		return;
+	}
+
+	ls->handler(ls, s);
+}
+
+RECEPTOR_API receptor_listening_t *
+receptor_event_listening_create(receptor_event_loop_t *loop, const struct sockaddr *sockaddr,
+	socklen_t socklen, receptor_accept_handler_pt handler)
+{
+	receptor_listening_t *ls;
+
+	if (socklen > (socklen_t)sizeof(struct sockaddr_storage)) {
+		return NULL;
+	}
+
+	ls = receptor_pcalloc(loop->pool, sizeof(receptor_listening_t));
+	if (ls == NULL) {
+		return NULL;
+	}
+
+	memcpy(&ls->sockaddr, sockaddr, socklen);
+	ls->socklen = socklen;
+	ls->backlog = RECEPTOR_DEFAULT_BACKLOG;
+	ls->accept_budget = RECEPTOR_EVENT_ACCEPT_BUDGET;
+	ls->fd = RECEPTOR_INVALID_SOCKET;
+	ls->loop = loop;
+	ls->handler = handler;
+
+	return ls;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_listening_open(receptor_listening_t *ls)
+{
+	int                     on = 1;
+	receptor_socket_t       s;
+	receptor_event_t       *rev, *wev;
+	receptor_connection_t  *c;
+
+	if (ls->open) {
+		return RECEPTOR_OK;
+	}
+
+	c = ls->connection;
+
+	if (c == NULL) {
+		c = receptor_pcalloc(ls->loop->pool, sizeof(receptor_connection_t));
+		rev = receptor_pcalloc(ls->loop->pool, sizeof(receptor_event_t));
+		wev = receptor_pcalloc(ls->loop->pool, sizeof(receptor_event_t));
+		if (c == NULL || rev == NULL || wev == NULL) {
+			return RECEPTOR_ERROR;
+		}
+
+		c->data = ls;
+		c->read = rev;
+		c->write = wev;
+
+		rev->data = c;
+		rev->handler = receptor_event_accept;
+		rev->accept = 1;
+		wev->data = c;
+		wev->write = 1;
+
+		ls->connection = c;
+	}
+
+	s = socket(ls->sockaddr.ss_family, SOCK_STREAM, 0);
+	if (s == RECEPTOR_INVALID_SOCKET) {
+		return RECEPTOR_ERROR;
+	}
+
+	if (setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&on, sizeof(on)) == -1) {
+		goto failed;
+	}
+
+	if (ls->reuseport) {
+#if defined(RECEPTOR_HAVE_SO_REUSEPORT) || defined(SO_REUSEPORT)
+		if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (const char *)&on, sizeof(on)) == -1) {
+			goto failed;
+		}
+#else
+		goto failed;
+#endif
+	}
+
+	/* 只是提示，内核不支持时忽略 */
+#ifdef SO_INCOMING_CPU
+	if (ls->incoming_cpu && ls->loop->cpu >= 0) {
+		int cpu = (int)ls->loop->cpu;
+
+		(void)setsockopt(s, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu));
+	}
+#endif
+
+	/* 连接上有数据到达时才通知 accept，省掉一次空读 */
+#if defined(RECEPTOR_HAVE_TCP_DEFER_ACCEPT) || defined(TCP_DEFER_ACCEPT)
+	if (ls->defer_accept > 0) {
+		int timeout = (int)ls->defer_accept;
+
+		if (setsockopt(s, IPPROTO_TCP, TCP_DEFER_ACCEPT, &timeout, sizeof(timeout)) == -1) {
+			goto failed;
+		}
+	}
+#endif
+
+	if (receptor_event_socket_nonblocking(s) != RECEPTOR_OK) {
+		goto failed;
+	}
+
+	if (bind(s, (struct sockaddr *)&ls->sockaddr, ls->socklen) == -1) {
+		goto failed;
+	}
+
+	if (listen(s, (int)ls->backlog) == -1) {
+		goto failed;
+	}
+
+	receptor_connection_set_fd(c, s);
+
+	if (receptor_event_loop_add(ls->loop, c->read, RECEPTOR_READ_EVENT, RECEPTOR_LEVEL_EVENT) != RECEPTOR_OK) {
+		receptor_connection_set_fd(c, RECEPTOR_INVALID_SOCKET);
+		goto failed;
+	}
+
+	ls->fd = s;
+	ls->open = 1;
+	receptor_queue_insert_tail(&ls->loop->listening, &ls->queue);
+
+	return RECEPTOR_OK;
+
+failed:
+
+	receptor_close_socket(s);
+	return RECEPTOR_ERROR;
+}
+
+RECEPTOR_API void
+receptor_event_listening_close(receptor_listening_t *ls)
+{
+	if (!ls->open) {
+		return;
+	}
+
+	receptor_event_del_timer(ls->loop, ls->connection->read);
+	ls->connection->read->timedout = 0;
+
+	receptor_event_loop_del(ls->loop, ls->connection->read, RECEPTOR_READ_EVENT, RECEPTOR_CLOSE_EVENT);
+	receptor_close_socket(ls->fd);
+
+	ls->fd = RECEPTOR_INVALID_SOCKET;
+	receptor_connection_set_fd(ls->connection, RECEPTOR_INVALID_SOCKET);
+	ls->open = 0;
+
+	receptor_queue_remove(&ls->queue);
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_group_listen(receptor_event_loop_group_t *group, const struct sockaddr *sockaddr,
+	socklen_t socklen, receptor_accept_handler_pt handler)
+{
+	receptor_uint_t         i, n;
+	receptor_listening_t   *ls;
+
+	n = receptor_event_loop_group_size(group);
+
+	for (i = 0; i < n; i++) {
+		ls = receptor_event_listening_create(receptor_event_loop_group_get(group, i), sockaddr, socklen, handler);
+		if (ls == NULL) {
+			return RECEPTOR_ERROR;
+		}
+
+		ls->reuseport = (n > 1);
+		ls->incoming_cpu = 1;
+
+		if (receptor_event_listening_open(ls) != RECEPTOR_OK) {
+			return RECEPTOR_ERROR;
+		}
+	}
+
+	return RECEPTOR_OK;
+}
+
+RECEPTOR_API void
+receptor_event_close_listening_sockets(receptor_event_loop_t *loop)
+{
+	receptor_queue_t       *q;
+	receptor_listening_t   *ls;
+
+	while (!receptor_queue_empty(&loop->listening)) {
+		q = receptor_queue_head(&loop->listening);
+		ls = receptor_queue_data(q, receptor_listening_t, queue);
+
+		receptor_event_listening_close(ls);
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef _RECEPTOR_EVENT_LISTEN_H_
+#define _RECEPTOR_EVENT_LISTEN_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 监听套接字 ==================== */
+
+	typedef struct receptor_listening_s  receptor_listening_t;
+
+	/* 每次监听事件就绪最多接受的连接数 */
+#define RECEPTOR_EVENT_ACCEPT_BUDGET    64
+
+	/* 描述符耗尽 (EMFILE/ENFILE) 时暂停接受的毫秒数 */
+#define RECEPTOR_EVENT_ACCEPT_DELAY     500
+
+	/* 新连接交给 handler，描述符已设为非阻塞，由 handler 负责关闭；可用 receptor_event_get_connection 从连接表取连接 */
+	typedef void(*receptor_accept_handler_pt)(receptor_listening_t *ls, receptor_socket_t s);
+
+	/*
+	 * 每个循环拥有自己的监听套接字。reuseport 置位时各循环以 SO_REUSEPORT
+	 * 绑定同一地址，由内核在套接字之间分配新连接，没有惊群也不需要 accept 锁。
+	 * incoming_cpu 置位且循环绑定了 CPU 时设置 SO_INCOMING_CPU，
+	 * 内核优先把在该 CPU 上收到的连接交给这个套接字 (无需 BPF 程序)。
+	 */
+	struct receptor_listening_s {
+		struct sockaddr_storage     sockaddr;
+		socklen_t                   socklen;
+		receptor_int_t              backlog;
+		receptor_uint_t             accept_budget;
+		receptor_uint_t             defer_accept;   /* TCP_DEFER_ACCEPT 秒数，0 不启用 */
+		receptor_socket_t           fd;
+		receptor_connection_t      *connection;
+		receptor_event_loop_t      *loop;
+		receptor_accept_handler_pt  handler;
+		void                       *data;
+		receptor_queue_t            queue;      /* 所属循环的监听链表节点 */
+		receptor_uint_t             reuseport : 1;
+		receptor_uint_t             incoming_cpu : 1;
+		receptor_uint_t             open : 1;
+	};
+
+	/* ==================== 监听API ==================== */
+
+	/* 在循环的内存池中创建监听结构，backlog 取 RECEPTOR_DEFAULT_BACKLOG，可在 open 之前修改各字段 */
+	RECEPTOR_API receptor_listening_t *receptor_event_listening_create(receptor_event_loop_t *loop,
+		const struct sockaddr *sockaddr, socklen_t socklen, receptor_accept_handler_pt handler);
+
+	/* 创建、绑定并监听套接字，读事件以 accept 事件注册到所属循环，须在循环线程上或循环运行前调用 */
+	RECEPTOR_API receptor_int_t receptor_event_listening_open(receptor_listening_t *ls);
+	RECEPTOR_API void receptor_event_listening_close(receptor_listening_t *ls);
+
+	/* 供完成式后端使用：把已接受的连接交给监听的 handler */
+	RECEPTOR_API void receptor_event_accept_socket(receptor_event_t *ev, receptor_socket_t s);
+
+	/*
+	 * 在循环组的每个循环上以 SO_REUSEPORT 打开同一地址的监听套接字，
+	 * 循环绑定了 CPU 时附带 SO_INCOMING_CPU 提示。须在 group_start 之前调用。
+	 */
+	RECEPTOR_API receptor_int_t receptor_event_loop_group_listen(receptor_event_loop_group_t *group,
+		const struct sockaddr *sockaddr, socklen_t socklen, receptor_accept_handler_pt handler);
+
+	/* 关闭循环上的所有监听套接字，销毁循环时自动调用 */
+	RECEPTOR_API void receptor_event_close_listening_sockets(receptor_event_loop_t *loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_LISTEN_H_ */
@@ -0,0 +1,237 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/* ==================== 多线程循环组实现 ==================== */
+
+#ifdef _WIN32
+typedef HANDLE              receptor_thread_t;
+#else
+typedef pthread_t           receptor_thread_t;
+#endif
+
+struct receptor_event_loop_group_s {
+	receptor_event_loop_t     **loops;
+	receptor_thread_t          *threads;
+	receptor_uint_t             n;
+	receptor_uint_t             started;
+	receptor_event_loop_init_pt init;
+	receptor_pool_t            *pool;
+};
+
+static receptor_uint_t
+receptor_event_ncpu(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO si;
+
+	GetSystemInfo(&si);
+	return (receptor_uint_t)si.dwNumberOfProcessors;
+#else
+	long n;
+
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (receptor_uint_t)n : 1;
+#endif
+}
+
+static void
+receptor_event_loop_pin(receptor_event_loop_t *loop)
+{
+	if (loop->cpu < 0) {
+		return;
+	}
+
+#ifdef _WIN32
+	SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << loop->cpu);
+#elif defined(__linux__)
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(loop->cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+receptor_event_loop_thread(LPVOID arg)
+#else
+static void *
+receptor_event_loop_thread(void *arg)
+#endif
+{
+	receptor_event_loop_t        *loop = arg;
+	receptor_event_loop_group_t  *group = loop->group;
+
+	receptor_event_loop_pin(loop);
+
+	if (group->init) {
+		group->init(loop);
+	}
+
+	receptor_event_loop_run(loop);
+
+#ifdef _WIN32
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
+RECEPTOR_API receptor_event_loop_group_t *
+receptor_event_loop_group_create(receptor_uint_t n, receptor_uint_t pin)
+{
+	receptor_uint_t               i, ncpu;
+	receptor_pool_t              *pool;
+	receptor_event_loop_group_t  *group;
+
+	if (n == 0) {
+		return NULL;
+	}
+
+	pool = receptor_create_pool(4096);
+	if (pool == NULL) {
+		return NULL;
+	}
+
+	group = receptor_pcalloc(pool, sizeof(receptor_event_loop_group_t));
+	if (group == NULL) {
+		receptor_destroy_pool(pool);
+		return NULL;
+	}
+
+	group->pool = pool;
+	group->loops = receptor_pcalloc(pool, n * sizeof(receptor_event_loop_t *));
+	group->threads = receptor_pcalloc(pool, n * sizeof(receptor_thread_t));
+	if (group->loops == NULL || group->threads == NULL) {
+		receptor_destroy_pool(pool);
+		return NULL;
+	}
+
+	ncpu = receptor_event_ncpu();
+
+	for (i = 0; i < n; i++) {
+		group->loops[i] = receptor_event_loop_create();
+		if (group->loops[i] == NULL) {
+			group->n = i;
+			receptor_event_loop_group_destroy(group);
+			return NULL;
+		}
+
+		group->loops[i]->index = i;
+		group->loops[i]->cpu = pin ? (receptor_int_t)(i % ncpu) : -1;
+		group->loops[i]->group = group;
+	}
+
+	group->n = n;
+
+	return group;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_group_start(receptor_event_loop_group_t *group, receptor_event_loop_init_pt init)
+{
+	receptor_uint_t i;
+
+	if (group == NULL || group->started) {
+		return RECEPTOR_ERROR;
+	}
+
+	group->init = init;
+
+	for (i = 0; i < group->n; i++) {
+#ifdef _WIN32
+		group->threads[i] = CreateThread(NULL, 0, receptor_event_loop_thread, group->loops[i], 0, NULL);
+		if (group->threads[i] == NULL) {
+			break;
+		}
+#else
+		if (pthread_create(&group->threads[i], NULL, receptor_event_loop_thread, group->loops[i]) != 0) {
+			break;
+		}
+#endif
+		group->started++;
+	}
+
+	if (group->started != group->n) {
+		receptor_event_loop_group_stop(group);
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
+}
+
+/* 通知所有循环停止并等待线程退出 */
+RECEPTOR_API void
+receptor_event_loop_group_stop(receptor_event_loop_group_t *group)
+{
+	receptor_uint_t i;
+
+	if (group == NULL) {
+		return;
+	}
+
+	for (i = 0; i < group->n; i++) {
+		receptor_event_loop_stop(group->loops[i]);
+	}
+
+	for (i = 0; i < group->started; i++) {
+#ifdef _WIN32
+		WaitForSingleObject(group->threads[i], INFINITE);
+		CloseHandle(group->threads[i]);
+#else
+		pthread_join(group->threads[i], NULL);
+#endif
+	}
+
+	group->started = 0;
+}
+
+RECEPTOR_API void
+receptor_event_loop_group_destroy(receptor_event_loop_group_t *group)
+{
+	receptor_uint_t i;
+
+	if (group == NULL) {
+		return;
+	}
+
+	receptor_event_loop_group_stop(group);
+
+	for (i = 0; i < group->n; i++) {
+		receptor_event_loop_destroy(group->loops[i]);
+	}
+
+	receptor_destroy_pool(group->pool);
+}
+
+RECEPTOR_API receptor_uint_t
+receptor_event_loop_group_size(receptor_event_loop_group_t *group)
+{
+	return group ? group->n : 0;
+}
+
+RECEPTOR_API receptor_event_loop_t *
+receptor_event_loop_group_get(receptor_event_loop_group_t *group, receptor_uint_t i)
+{
+	if (group == NULL || i >= group->n) {
+		return NULL;
+	}
+
+	return group->loops[i];
+}
@@ -0,0 +1,65 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_metrics.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* ==================== 循环埋点实现 ==================== */
+
+RECEPTOR_API uint64_t
+receptor_event_time_ns(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER    freq;
+	LARGE_INTEGER           now;
+
+	if (freq.QuadPart == 0) {
+		QueryPerformanceFrequency(&freq);
+	}
+
+	QueryPerformanceCounter(&now);
+
+	return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000
+		+ (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/*
+ * 埋点默认关闭，关闭时热路径上只多一次指针判断。须在循环线程上
+ * 或循环运行之前调用。直方图约 19KB，超出内存池单次分配的上限，直接 malloc。
+ */
+RECEPTOR_API receptor_int_t
+receptor_event_loop_enable_metrics(receptor_event_loop_t *loop)
+{
+	receptor_event_loop_metrics_t *m;
+
+	if (loop->metrics) {
+		return RECEPTOR_OK;
+	}
+
+	m = calloc(1, sizeof(receptor_event_loop_metrics_t));
+	if (m == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	/* 其它线程经 receptor_event_loop_get_metrics 读取，发布前清零的内容须可见 */
+	(void)receptor_atomic_exchange_ptr(&loop->metrics, m);
+
+	return RECEPTOR_OK;
+}
+
+RECEPTOR_API const receptor_event_loop_metrics_t *
+receptor_event_loop_get_metrics(receptor_event_loop_t *loop)
+{
+	return receptor_atomic_load_ptr(&loop->metrics);
+}
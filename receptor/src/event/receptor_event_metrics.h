@@ -0,0 +1,49 @@
+#ifndef _RECEPTOR_EVENT_METRICS_H_
+#define _RECEPTOR_EVENT_METRICS_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 循环埋点 ==================== */
+
+	/* 单调时钟，纳秒 */
+	RECEPTOR_API uint64_t receptor_event_time_ns(void);
+
+	/* 后端等待返回后立即调用，n 为取回的事件数 */
+	static RECEPTOR_INLINE void
+	receptor_event_wakeup(receptor_event_loop_t *loop, receptor_uint_t n)
+	{
+		receptor_atomic_store_relaxed(&loop->stats.events, loop->stats.events + n);
+
+		if (loop->metrics) {
+			receptor_histogram_record(&loop->metrics->blocked, receptor_event_time_ns() - loop->wait_start);
+			receptor_histogram_record(&loop->metrics->events, n);
+		}
+	}
+
+	/* 调用处理函数，开启埋点时记录耗时 */
+	static RECEPTOR_INLINE void
+	receptor_event_call(receptor_event_loop_t *loop, receptor_event_t *ev)
+	{
+		uint64_t start;
+
+		if (loop->metrics == NULL) {
+			ev->handler(ev);
+			return;
+		}
+
+		start = receptor_event_time_ns();
+		ev->handler(ev);
+		receptor_histogram_record(&loop->metrics->handler, receptor_event_time_ns() - start);
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_METRICS_H_ */
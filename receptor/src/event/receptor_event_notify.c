@@ -0,0 +1,231 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_notify.h>
+#include <receptor_atomic.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+/* ==================== 循环唤醒通道实现 ==================== */
+
+/*
+ * Linux 使用 eventfd，其它 Unix 使用非阻塞管道；后端自带唤醒机制时
+ * (IOCP 投递完成包) 不创建描述符。任务队列是无锁的多生产者单消费者栈：
+ * 投递方 CAS 压栈，只有栈由空变为非空的投递方才写通道，循环线程
+ * 一次摘下整个栈并反转为投递顺序执行。
+ */
+
+static void
+receptor_event_notify_handler(receptor_event_t *ev)
+{
+	receptor_connection_t  *c = ev->data;
+	receptor_event_loop_t  *loop = c->data;
+	receptor_event_task_t  *head, *task, *next;
+
+#ifndef _WIN32
+	/* 先清空通道再摘任务，之后压栈的投递方会再次写通道 */
+	if (c->fd != RECEPTOR_INVALID_SOCKET) {
+#ifdef __linux__
+		uint64_t    count;
+
+		(void)read(c->fd, &count, sizeof(count));
+#else
+		char        buf[64];
+
+		while (read(c->fd, buf, sizeof(buf)) > 0) {
+			/* void */
+		}
+#endif
+	}
+#endif
+
+	head = receptor_atomic_exchange_ptr(&loop->tasks, NULL);
+
+	for (task = NULL; head; head = next) {
+		next = head->next;
+		head->next = task;
+		task = head;
+	}
+
+	for ( /* void */; task; task = next) {
+		next = task->next;
+		task->handler(task);
+	}
+}
+
+#if !defined(_WIN32) && !defined(__linux__)
+
+static receptor_int_t
+receptor_event_notify_nonblocking(int fd)
+{
+	int flags;
+
+	flags = fcntl(fd, F_GETFL);
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
+}
+
+#endif
+
+/* 失败时由调用者执行 receptor_event_notify_done 释放已创建的描述符 */
+RECEPTOR_API receptor_int_t
+receptor_event_notify_init(receptor_event_loop_t *loop)
+{
+	receptor_event_t       *rev, *wev;
+	receptor_connection_t  *c;
+#if !defined(_WIN32) && !defined(__linux__)
+	int                     fds[2];
+#endif
+
+	c = receptor_pcalloc(loop->pool, sizeof(receptor_connection_t));
+	rev = receptor_pcalloc(loop->pool, sizeof(receptor_event_t));
+	wev = receptor_pcalloc(loop->pool, sizeof(receptor_event_t));
+	if (c == NULL || rev == NULL || wev == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	c->data = loop;
+	c->read = rev;
+	c->write = wev;
+	receptor_connection_set_fd(c, RECEPTOR_INVALID_SOCKET);
+
+	rev->data = c;
+	rev->handler = receptor_event_notify_handler;
+	wev->data = c;
+	wev->write = 1;
+
+	loop->notify = c;
+	loop->notify_fd = RECEPTOR_INVALID_SOCKET;
+
+	if (loop->actions.notify) {
+		return RECEPTOR_OK;
+	}
+
+#ifdef _WIN32
+	/* select 后端在 Windows 下没有可用的唤醒描述符，只能等超时 */
+	return RECEPTOR_OK;
+#else
+
+#ifdef __linux__
+	c->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (c->fd == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	receptor_connection_set_fd(c, c->fd);
+
+	loop->notify_fd = c->fd;
+#else
+	if (pipe(fds) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	receptor_connection_set_fd(c, fds[0]);
+	loop->notify_fd = fds[1];
+
+	if (receptor_event_notify_nonblocking(fds[0]) != RECEPTOR_OK
+		|| receptor_event_notify_nonblocking(fds[1]) != RECEPTOR_OK)
+	{
+		return RECEPTOR_ERROR;
+	}
+#endif
+
+	return loop->actions.add(loop, rev, RECEPTOR_READ_EVENT, RECEPTOR_CLEAR_EVENT);
+#endif
+}
+
+RECEPTOR_API void
+receptor_event_notify_done(receptor_event_loop_t *loop)
+{
+	receptor_connection_t *c = loop->notify;
+
+	if (c == NULL) {
+		return;
+	}
+
+#ifndef _WIN32
+	if (c->read->active) {
+		loop->actions.del(loop, c->read, RECEPTOR_READ_EVENT, RECEPTOR_CLOSE_EVENT);
+	}
+
+	if (loop->notify_fd != RECEPTOR_INVALID_SOCKET && loop->notify_fd != c->fd) {
+		close(loop->notify_fd);
+	}
+
+	if (c->fd != RECEPTOR_INVALID_SOCKET) {
+		close(c->fd);
+	}
+#endif
+
+	loop->notify = NULL;
+	loop->notify_fd = RECEPTOR_INVALID_SOCKET;
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_notify(receptor_event_loop_t *loop)
+{
+#ifndef _WIN32
+	ssize_t     n;
+#ifdef __linux__
+	uint64_t    one = 1;
+#endif
+#endif
+
+	if (loop->actions.notify) {
+		return loop->actions.notify(loop);
+	}
+
+#ifdef _WIN32
+	return RECEPTOR_ERROR;
+#else
+	if (loop->notify_fd == RECEPTOR_INVALID_SOCKET) {
+		return RECEPTOR_ERROR;
+	}
+
+#ifdef __linux__
+	n = write(loop->notify_fd, &one, sizeof(one));
+#else
+	n = write(loop->notify_fd, "", 1);
+#endif
+
+	/* EAGAIN 说明已有未读的通知，循环一定会醒来 */
+	if (n == -1 && errno != EAGAIN) {
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
+#endif
+}
+
+RECEPTOR_API receptor_int_t
+receptor_event_loop_post_task(receptor_event_loop_t *loop, receptor_event_task_t *task)
+{
+	receptor_event_task_t *head;
+
+	head = receptor_atomic_load_ptr(&loop->tasks);
+
+	do {
+		task->next = head;
+	} while (!receptor_atomic_cas_ptr((void *volatile *)&loop->tasks, (void **)&head, task));
+
+	/* 栈原本非空时，先前的投递方已经 (或即将) 唤醒循环 */
+	if (head != NULL) {
+		return RECEPTOR_OK;
+	}
+
+	return receptor_event_loop_notify(loop);
+}
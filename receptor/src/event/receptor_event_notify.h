@@ -0,0 +1,21 @@
+#ifndef _RECEPTOR_EVENT_NOTIFY_H_
+#define _RECEPTOR_EVENT_NOTIFY_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 循环唤醒通道 ==================== */
+
+	/* 在后端初始化之后创建，读端以边沿触发注册到循环中 */
+	RECEPTOR_API receptor_int_t receptor_event_notify_init(receptor_event_loop_t *loop);
+	RECEPTOR_API void receptor_event_notify_done(receptor_event_loop_t *loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_NOTIFY_H_ */
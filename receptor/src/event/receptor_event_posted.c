@@ -0,0 +1,30 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_posted.h>
+
+/* ==================== 延迟事件处理 ==================== */
+
+/* 每次都从队头取，处理函数删除或追加队列中的事件都是安全的 */
+RECEPTOR_API receptor_uint_t
+receptor_event_process_posted(receptor_event_loop_t *loop, receptor_queue_t *posted, receptor_uint_t max)
+{
+	receptor_uint_t     n;
+	receptor_queue_t   *q;
+	receptor_event_t   *ev;
+
+	for (n = 0; !receptor_queue_empty(posted); n++) {
+
+		if (max && n == max) {
+			break;
+		}
+
+		q = receptor_queue_head(posted);
+		ev = receptor_queue_data(q, receptor_event_t, queue);
+
+		receptor_delete_posted_event(ev);
+
+		receptor_event_call(loop, ev);
+	}
+
+	return n;
+}
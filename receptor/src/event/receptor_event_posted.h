@@ -0,0 +1,57 @@
+#ifndef _RECEPTOR_EVENT_POSTED_H_
+#define _RECEPTOR_EVENT_POSTED_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_metrics.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 延迟事件队列 ==================== */
+
+	/*
+	 * 开启 post_events 后，后端取回的就绪事件不在等待结果的循环里直接处理，
+	 * 而是挂到循环的队列上：accept 事件先于其它事件处理，普通事件
+	 * 在定时器之后处理，每轮至多处理 posted_max 个，其余留到下一轮。
+	 * 处理函数也可以把自己挂到 posted_events 上，推迟到本轮末尾再执行。
+	 */
+
+#define receptor_post_event(ev, q)                                            \
+                                                                              \
+    if (!(ev)->posted) {                                                      \
+        (ev)->posted = 1;                                                     \
+        receptor_queue_insert_tail(q, &(ev)->queue);                          \
+    }
+
+#define receptor_delete_posted_event(ev)                                      \
+                                                                              \
+    (ev)->posted = 0;                                                         \
+    receptor_queue_remove(&(ev)->queue)
+
+	/* 后端取回就绪事件后调用：按循环的设置直接处理或挂到对应队列 */
+	static RECEPTOR_INLINE void
+	receptor_event_dispatch(receptor_event_loop_t *loop, receptor_event_t *ev)
+	{
+		if (loop->post_events) {
+			if (ev->accept) {
+				receptor_post_event(ev, &loop->posted_accept_events);
+			}
+			else {
+				receptor_post_event(ev, &loop->posted_events);
+			}
+			return;
+		}
+
+		receptor_event_call(loop, ev);
+	}
+
+	/* 处理队列中的事件，max 为 0 表示不限数量，返回处理的个数 */
+	RECEPTOR_API receptor_uint_t receptor_event_process_posted(receptor_event_loop_t *loop, receptor_queue_t *posted, receptor_uint_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_POSTED_H_ */
@@ -0,0 +1,308 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_signal.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#ifdef __linux__
+#include <sys/signalfd.h>
+#endif
+
+/* ==================== 信号通道实现 ==================== */
+
+/*
+ * 信号是进程级的，整个进程只有一个信号通道，绑定到第一次注册信号的循环。
+ * Linux 下屏蔽这些信号并用 signalfd 读取；其它 Unix 用自管道，
+ * 信号处理函数只向管道写入信号编号。两种方式下注册的处理函数都在
+ * 循环线程上作为普通读事件执行，可以安全地调用任何接口。
+ */
+
+#ifndef _WIN32
+
+#ifdef NSIG
+#define RECEPTOR_EVENT_NSIG     NSIG
+#else
+#define RECEPTOR_EVENT_NSIG     65
+#endif
+
+typedef struct {
+	receptor_event_loop_t      *loop;
+	receptor_connection_t      *conn;
+	receptor_event_signal_pt    handlers[RECEPTOR_EVENT_NSIG];
+#ifdef __linux__
+	sigset_t                    mask;
+#else
+	int                         write_fd;
+#endif
+} receptor_event_signal_ctx_t;
+
+static receptor_event_signal_ctx_t  receptor_event_signal_ctx;
+
+static void
+receptor_event_signal_dispatch(int signo)
+{
+	receptor_event_signal_pt handler;
+
+	if (signo <= 0 || signo >= RECEPTOR_EVENT_NSIG) {
+		return;
+	}
+
+	handler = receptor_event_signal_ctx.handlers[signo];
+
+	if (handler) {
+		handler(signo);
+	}
+}
+
+static void
+receptor_event_signal_handler(receptor_event_t *ev)
+{
+	receptor_connection_t  *c = ev->data;
+	ssize_t                 n, i;
+#ifdef __linux__
+	struct signalfd_siginfo si[8];
+#else
+	unsigned char           buf[64];
+#endif
+
+	/* 边沿触发，读到 EAGAIN 为止 */
+	for ( ;; ) {
+#ifdef __linux__
+		n = read(c->fd, si, sizeof(si));
+		if (n <= 0) {
+			break;
+		}
+
+		for (i = 0; i < n / (ssize_t)sizeof(struct signalfd_siginfo); i++) {
+			receptor_event_signal_dispatch((int)si[i].ssi_signo);
+		}
+#else
+		n = read(c->fd, buf, sizeof(buf));
+		if (n <= 0) {
+			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			receptor_event_signal_dispatch(buf[i]);
+		}
+#endif
+	}
+}
+
+#ifndef __linux__
+
+static void
+receptor_event_signal_write(int signo)
+{
+	int             err;
+	unsigned char   b;
+
+	/* 只调用异步信号安全的 write，并保留被打断代码的 errno */
+	err = errno;
+	b = (unsigned char)signo;
+	(void)write(receptor_event_signal_ctx.write_fd, &b, 1);
+	errno = err;
+}
+
+static receptor_int_t
+receptor_event_signal_nonblocking(int fd)
+{
+	int flags;
+
+	flags = fcntl(fd, F_GETFL);
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	return RECEPTOR_OK;
+}
+
+#endif
+
+/* 第一次注册时创建通道并把读端加入循环 */
+static receptor_int_t
+receptor_event_signal_open(receptor_event_loop_t *loop)
+{
+	receptor_event_signal_ctx_t    *ctx = &receptor_event_signal_ctx;
+	receptor_connection_t          *c;
+	receptor_event_t               *rev, *wev;
+#ifndef __linux__
+	int                             fds[2];
+#endif
+
+	c = receptor_pcalloc(loop->pool, sizeof(receptor_connection_t));
+	rev = receptor_pcalloc(loop->pool, sizeof(receptor_event_t));
+	wev = receptor_pcalloc(loop->pool, sizeof(receptor_event_t));
+	if (c == NULL || rev == NULL || wev == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	c->data = loop;
+	c->read = rev;
+	c->write = wev;
+
+	rev->data = c;
+	rev->handler = receptor_event_signal_handler;
+	wev->data = c;
+	wev->write = 1;
+
+#ifdef __linux__
+	sigemptyset(&ctx->mask);
+
+	c->fd = signalfd(-1, &ctx->mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (c->fd == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	receptor_connection_set_fd(c, c->fd);
+#else
+	if (pipe(fds) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	if (receptor_event_signal_nonblocking(fds[0]) != RECEPTOR_OK
+		|| receptor_event_signal_nonblocking(fds[1]) != RECEPTOR_OK)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return RECEPTOR_ERROR;
+	}
+
+	receptor_connection_set_fd(c, fds[0]);
+	ctx->write_fd = fds[1];
+#endif
+
+	if (receptor_event_loop_add(loop, rev, RECEPTOR_READ_EVENT, RECEPTOR_CLEAR_EVENT) != RECEPTOR_OK) {
+		close(c->fd);
+#ifndef __linux__
+		close(ctx->write_fd);
+#endif
+		return RECEPTOR_ERROR;
+	}
+
+	ctx->loop = loop;
+	ctx->conn = c;
+
+	return RECEPTOR_OK;
+}
+
+#endif /* _WIN32 */
+
+/*
+ * Linux 下注册的信号在调用线程中被屏蔽，之后创建的线程继承屏蔽字，
+ * 因此应在启动循环组和其它线程之前注册，否则信号可能按默认动作递送给其它线程。
+ */
+RECEPTOR_API receptor_int_t
+receptor_event_loop_add_signal(receptor_event_loop_t *loop, int signo, receptor_event_signal_pt handler)
+{
+#ifdef _WIN32
+	(void)loop;
+	(void)signo;
+	(void)handler;
+	return RECEPTOR_ERROR;
+#else
+	receptor_event_signal_ctx_t    *ctx = &receptor_event_signal_ctx;
+#ifdef __linux__
+	sigset_t                        set;
+#else
+	struct sigaction                sa;
+#endif
+
+	if (loop == NULL || signo <= 0 || signo >= RECEPTOR_EVENT_NSIG || handler == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	if (ctx->loop == NULL) {
+		if (receptor_event_signal_open(loop) != RECEPTOR_OK) {
+			return RECEPTOR_ERROR;
+		}
+	}
+	else if (ctx->loop != loop) {
+		return RECEPTOR_ERROR;
+	}
+
+	ctx->handlers[signo] = handler;
+
+#ifdef __linux__
+	sigemptyset(&set);
+	sigaddset(&set, signo);
+
+	if (pthread_sigmask(SIG_BLOCK, &set, NULL) != 0) {
+		return RECEPTOR_ERROR;
+	}
+
+	sigaddset(&ctx->mask, signo);
+
+	if (signalfd(ctx->conn->fd, &ctx->mask, 0) == -1) {
+		return RECEPTOR_ERROR;
+	}
+#else
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = receptor_event_signal_write;
+	sa.sa_flags = SA_RESTART;
+	sigfillset(&sa.sa_mask);
+
+	if (sigaction(signo, &sa, NULL) == -1) {
+		return RECEPTOR_ERROR;
+	}
+#endif
+
+	return RECEPTOR_OK;
+#endif
+}
+
+RECEPTOR_API void
+receptor_event_signal_done(receptor_event_loop_t *loop)
+{
+#ifndef _WIN32
+	receptor_event_signal_ctx_t    *ctx = &receptor_event_signal_ctx;
+	int                             signo;
+#ifndef __linux__
+	struct sigaction                sa;
+#endif
+
+	if (ctx->loop != loop) {
+		return;
+	}
+
+	receptor_event_loop_del(loop, ctx->conn->read, RECEPTOR_READ_EVENT, RECEPTOR_CLOSE_EVENT);
+	close(ctx->conn->fd);
+
+#ifdef __linux__
+	pthread_sigmask(SIG_UNBLOCK, &ctx->mask, NULL);
+#else
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = SIG_DFL;
+	sigemptyset(&sa.sa_mask);
+#endif
+
+	for (signo = 1; signo < RECEPTOR_EVENT_NSIG; signo++) {
+#ifndef __linux__
+		if (ctx->handlers[signo]) {
+			sigaction(signo, &sa, NULL);
+		}
+#endif
+		ctx->handlers[signo] = NULL;
+	}
+
+#ifndef __linux__
+	close(ctx->write_fd);
+#endif
+
+	ctx->loop = NULL;
+	ctx->conn = NULL;
+#else
+	(void)loop;
+#endif
+}
@@ -0,0 +1,20 @@
+#ifndef _RECEPTOR_EVENT_SIGNAL_H_
+#define _RECEPTOR_EVENT_SIGNAL_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 信号通道 ==================== */
+
+	/* 循环销毁时调用，信号通道属于该循环时关闭描述符并恢复信号屏蔽 */
+	RECEPTOR_API void receptor_event_signal_done(receptor_event_loop_t *loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_SIGNAL_H_ */
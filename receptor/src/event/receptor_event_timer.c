@@ -0,0 +1,359 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_timer.h>
+#include <receptor_event_metrics.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* ==================== 分层时间轮实现 ==================== */
+
+#define RECEPTOR_TIMER_MASK0        (RECEPTOR_TIMER_WHEEL_SIZE0 - 1)
+#define RECEPTOR_TIMER_MASKN        (RECEPTOR_TIMER_WHEEL_SIZEN - 1)
+#define RECEPTOR_TIMER_SPAN         ((receptor_msec_t) 1 << (RECEPTOR_TIMER_WHEEL_BITS0 \
+                                        + (RECEPTOR_TIMER_WHEEL_LEVELS - 1) * RECEPTOR_TIMER_WHEEL_BITSN))
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static RECEPTOR_INLINE receptor_uint_t
+receptor_timer_ctz64(uint64_t x)
+{
+	unsigned long i;
+
+	_BitScanForward64(&i, x);
+	return (receptor_uint_t)i;
+}
+#else
+#define receptor_timer_ctz64(x)    (receptor_uint_t)__builtin_ctzll(x)
+#endif
+
+/* 第 level 层 (从 1 开始) 的槽位下标 */
+#define receptor_timer_index(t, level)                                        \
+    (receptor_uint_t) (((t) >> (RECEPTOR_TIMER_WHEEL_BITS0                    \
+        + ((level) - 1) * RECEPTOR_TIMER_WHEEL_BITSN)) & RECEPTOR_TIMER_MASKN)
+
+static void
+receptor_event_timer_link(receptor_event_timer_wheel_t *w, receptor_event_t *ev)
+{
+	receptor_uint_t     i, level;
+	receptor_msec_t     expires, idx;
+	receptor_queue_t   *slot;
+
+	expires = ev->timer_expires;
+	idx = expires - w->now;
+
+	if (idx < 0) {
+		expires = w->now;
+		idx = 0;
+	}
+
+	if (idx < RECEPTOR_TIMER_WHEEL_SIZE0) {
+		i = (receptor_uint_t)(expires & RECEPTOR_TIMER_MASK0);
+		slot = &w->slot0[i];
+		w->bitmap0[i >> 6] |= (uint64_t)1 << (i & 63);
+		receptor_queue_insert_tail(slot, &ev->timer);
+		return;
+	}
+
+	/* 超出总跨度的先放在最高层最远的槽，级联时按真实到期时间重新放置 */
+	if (idx >= RECEPTOR_TIMER_SPAN) {
+		expires = w->now + RECEPTOR_TIMER_SPAN - 1;
+		idx = RECEPTOR_TIMER_SPAN - 1;
+	}
+
+	for (level = 1; level < RECEPTOR_TIMER_WHEEL_LEVELS - 1; level++) {
+		if (idx < (receptor_msec_t)1 << (RECEPTOR_TIMER_WHEEL_BITS0 + level * RECEPTOR_TIMER_WHEEL_BITSN)) {
+			break;
+		}
+	}
+
+	i = receptor_timer_index(expires, level);
+	slot = &w->slotn[level - 1][i];
+
+	if (level == 1) {
+		w->bitmap1 |= (uint64_t)1 << i;
+	}
+
+	receptor_queue_insert_tail(slot, &ev->timer);
+}
+
+/* 把第 level 层第 i 个槽的定时器重新放到更低的层 */
+static receptor_uint_t
+receptor_event_timer_cascade(receptor_event_timer_wheel_t *w, receptor_uint_t level, receptor_uint_t i)
+{
+	receptor_queue_t    list, *slot, *q;
+	receptor_event_t   *ev;
+
+	slot = &w->slotn[level - 1][i];
+
+	if (receptor_queue_empty(slot)) {
+		return i;
+	}
+
+	list.next = slot->next;
+	list.prev = slot->prev;
+	list.next->prev = &list;
+	list.prev->next = &list;
+	receptor_queue_init(slot);
+
+	while (!receptor_queue_empty(&list)) {
+		q = receptor_queue_head(&list);
+		receptor_queue_remove(q);
+
+		ev = receptor_queue_data(q, receptor_event_t, timer);
+		receptor_event_timer_link(w, ev);
+	}
+
+	return i;
+}
+
+RECEPTOR_API void
+receptor_event_time_update(receptor_event_loop_t *loop)
+{
+#ifdef _WIN32
+	loop->current_msec = (receptor_msec_t)GetTickCount64();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	loop->current_msec = (receptor_msec_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+RECEPTOR_API void
+receptor_event_timer_init(receptor_event_loop_t *loop)
+{
+	receptor_uint_t                 i, level;
+	receptor_event_timer_wheel_t   *w = &loop->timers;
+
+	for (i = 0; i < RECEPTOR_TIMER_WHEEL_SIZE0; i++) {
+		receptor_queue_init(&w->slot0[i]);
+	}
+
+	for (level = 0; level < RECEPTOR_TIMER_WHEEL_LEVELS - 1; level++) {
+		for (i = 0; i < RECEPTOR_TIMER_WHEEL_SIZEN; i++) {
+			receptor_queue_init(&w->slotn[level][i]);
+		}
+	}
+
+	for (i = 0; i < RECEPTOR_TIMER_WHEEL_SIZE0 / 64; i++) {
+		w->bitmap0[i] = 0;
+	}
+
+	w->bitmap1 = 0;
+	w->count = 0;
+
+	receptor_event_time_update(loop);
+	w->now = loop->current_msec;
+}
+
+RECEPTOR_API void
+receptor_event_add_timer(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_msec_t timer)
+{
+	receptor_msec_t expires, diff;
+
+	expires = loop->current_msec + timer;
+
+	if (ev->timer_set) {
+		/* 长连接频繁重设超时，到期时间变化很小时省掉一次摘链和插入 */
+		diff = expires - ev->timer_expires;
+
+		if (diff > -RECEPTOR_TIMER_LAZY_DELAY && diff < RECEPTOR_TIMER_LAZY_DELAY) {
+			return;
+		}
+
+		receptor_event_del_timer(loop, ev);
+	}
+
+	ev->timer_expires = expires;
+	ev->timer_set = 1;
+	ev->timedout = 0;
+
+	receptor_event_timer_link(&loop->timers, ev);
+	loop->timers.count++;
+}
+
+RECEPTOR_API void
+receptor_event_del_timer(receptor_event_loop_t *loop, receptor_event_t *ev)
+{
+	if (!ev->timer_set) {
+		return;
+	}
+
+	receptor_queue_remove(&ev->timer);
+	ev->timer_set = 0;
+	loop->timers.count--;
+}
+
+/* 在位图中查找 [from, SIZE0) 内第一个非空槽，顺便清除已变空的位 */
+static receptor_int_t
+receptor_event_timer_scan0(receptor_event_timer_wheel_t *w, receptor_uint_t from)
+{
+	uint64_t            word;
+	receptor_uint_t     i, bit;
+
+	for (i = from >> 6; i < RECEPTOR_TIMER_WHEEL_SIZE0 / 64; i++) {
+		word = w->bitmap0[i];
+
+		if (i == (from >> 6)) {
+			word &= ~(uint64_t)0 << (from & 63);
+		}
+
+		while (word) {
+			bit = receptor_timer_ctz64(word);
+
+			if (!receptor_queue_empty(&w->slot0[i * 64 + bit])) {
+				return (receptor_int_t)(i * 64 + bit);
+			}
+
+			w->bitmap0[i] &= ~((uint64_t)1 << bit);
+			word &= word - 1;
+		}
+	}
+
+	return -1;
+}
+
+static receptor_int_t
+receptor_event_timer_scan1(receptor_event_timer_wheel_t *w, receptor_uint_t from)
+{
+	uint64_t            word;
+	receptor_uint_t     bit;
+
+	word = w->bitmap1 & (~(uint64_t)0 << from);
+
+	while (word) {
+		bit = receptor_timer_ctz64(word);
+
+		if (!receptor_queue_empty(&w->slotn[0][bit])) {
+			return (receptor_int_t)bit;
+		}
+
+		w->bitmap1 &= ~((uint64_t)1 << bit);
+		word &= word - 1;
+	}
+
+	return -1;
+}
+
+/*
+ * 只看前两层即可给出不晚于真实到期的等待时间：
+ * 第 0 层当前轮内的槽位精确到毫秒，其余情况返回下一次级联的时刻，
+ * 醒来级联后再重新计算。
+ */
+RECEPTOR_API receptor_msec_t
+receptor_event_find_timer(receptor_event_loop_t *loop)
+{
+	receptor_int_t                  j;
+	receptor_uint_t                 cur, l1;
+	receptor_msec_t                 tick;
+	receptor_event_timer_wheel_t   *w = &loop->timers;
+
+	if (w->count == 0) {
+		return RECEPTOR_TIMER_INFINITE;
+	}
+
+	cur = (receptor_uint_t)(w->now & RECEPTOR_TIMER_MASK0);
+
+	/* 级联尚未执行，上层可能有更早到期的定时器 */
+	if (cur == 0) {
+		tick = w->now;
+		goto found;
+	}
+
+	j = receptor_event_timer_scan0(w, cur);
+
+	if (j >= 0) {
+		tick = w->now + (j - (receptor_int_t)cur);
+		goto found;
+	}
+
+	/* 下一次第 1 层级联的刻度 */
+	tick = w->now + (RECEPTOR_TIMER_WHEEL_SIZE0 - cur);
+
+	if (receptor_event_timer_scan0(w, 0) >= 0) {
+		goto found;
+	}
+
+	l1 = receptor_timer_index(tick, 1);
+
+	/* 该刻度同时级联第 2 层 */
+	if (l1 == 0) {
+		goto found;
+	}
+
+	j = receptor_event_timer_scan1(w, l1);
+
+	if (j >= 0) {
+		tick += (receptor_msec_t)(j - (receptor_int_t)l1) << RECEPTOR_TIMER_WHEEL_BITS0;
+	}
+	else {
+		tick += (receptor_msec_t)(RECEPTOR_TIMER_WHEEL_SIZEN - l1) << RECEPTOR_TIMER_WHEEL_BITS0;
+	}
+
+found:
+
+	return (tick > loop->current_msec) ? tick - loop->current_msec : 0;
+}
+
+RECEPTOR_API void
+receptor_event_expire_timers(receptor_event_loop_t *loop)
+{
+	receptor_uint_t                 i, level;
+	receptor_queue_t                list, *slot, *q;
+	receptor_event_t               *ev;
+	receptor_event_timer_wheel_t   *w = &loop->timers;
+
+	while (w->now <= loop->current_msec) {
+
+		if (w->count == 0) {
+			w->now = loop->current_msec + 1;
+			return;
+		}
+
+		i = (receptor_uint_t)(w->now & RECEPTOR_TIMER_MASK0);
+
+		if (i == 0) {
+			for (level = 1; level < RECEPTOR_TIMER_WHEEL_LEVELS; level++) {
+				if (receptor_event_timer_cascade(w, level, receptor_timer_index(w->now, level)) != 0) {
+					break;
+				}
+			}
+		}
+
+		slot = &w->slot0[i];
+
+		/*
+		 * 先把到期的槽摘下再前移刻度，处理函数中重新添加的
+		 * 零超时定时器会落到后面的槽，不会在本轮反复触发。
+		 */
+		if (receptor_queue_empty(slot)) {
+			w->now++;
+			continue;
+		}
+
+		list.next = slot->next;
+		list.prev = slot->prev;
+		list.next->prev = &list;
+		list.prev->next = &list;
+		receptor_queue_init(slot);
+
+		w->now++;
+
+		while (!receptor_queue_empty(&list)) {
+			q = receptor_queue_head(&list);
+			receptor_queue_remove(q);
+
+			ev = receptor_queue_data(q, receptor_event_t, timer);
+			ev->timer_set = 0;
+			ev->timedout = 1;
+			w->count--;
+
+			receptor_event_call(loop, ev);
+		}
+	}
+}
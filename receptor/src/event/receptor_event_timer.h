@@ -0,0 +1,31 @@
+#ifndef _RECEPTOR_EVENT_TIMER_H_
+#define _RECEPTOR_EVENT_TIMER_H_
+
+#include <receptor/def.h>
+#include <receptor_event.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* ==================== 定时器API ==================== */
+
+	/* 重新设置的到期时间与原来相差不到该值时不移动定时器 */
+#define RECEPTOR_TIMER_LAZY_DELAY   300
+
+	RECEPTOR_API void receptor_event_timer_init(receptor_event_loop_t *loop);
+	RECEPTOR_API void receptor_event_time_update(receptor_event_loop_t *loop);
+
+	/* 添加或重设定时器，timer 为相对时间（毫秒），到期后置 ev->timedout 并调用 handler */
+	RECEPTOR_API void receptor_event_add_timer(receptor_event_loop_t *loop, receptor_event_t *ev, receptor_msec_t timer);
+	RECEPTOR_API void receptor_event_del_timer(receptor_event_loop_t *loop, receptor_event_t *ev);
+
+	/* 距最近到期的毫秒数，没有定时器时返回 RECEPTOR_TIMER_INFINITE */
+	RECEPTOR_API receptor_msec_t receptor_event_find_timer(receptor_event_loop_t *loop);
+	RECEPTOR_API void receptor_event_expire_timers(receptor_event_loop_t *loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RECEPTOR_EVENT_TIMER_H_ */
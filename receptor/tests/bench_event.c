@@ -0,0 +1,590 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_timer.h>
+#include <receptor_event_metrics.h>
+#include <receptor_event_connection.h>
+#include <receptor_histogram.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/* ==================== 事件层基准测试 ==================== */
+
+/*
+ * 依次用每个已编译的后端跑几种典型负载，输出每秒事件数和延迟分位数：
+ *   pingpong  N 对套接字各自来回传一个字节
+ *   fanin     N 个连接同时就绪，测一轮突发从写入到全部处理完的延迟
+ *   timers    大量短定时器反复到期和重设
+ *   idle      大量空闲连接中只有少数在收发，测后端随描述符数的退化
+ *
+ * 用法: receptor_bench_event [backend ...]，不带参数时跑全部后端。
+ * IOCP 不是就绪通知模型，不在此列。
+ */
+
+#define RECEPTOR_BENCH_PINGPONG_PAIRS       64
+#define RECEPTOR_BENCH_PINGPONG_MESSAGES    200000
+#define RECEPTOR_BENCH_FANIN_CONNS          256
+#define RECEPTOR_BENCH_FANIN_ROUNDS         400
+#define RECEPTOR_BENCH_TIMERS               10000
+#define RECEPTOR_BENCH_TIMER_CHURN          256     /* 每轮循环重设的定时器数 */
+#define RECEPTOR_BENCH_TIMER_DURATION       1000    /* 毫秒 */
+#define RECEPTOR_BENCH_IDLE_CONNS           400     /* select 受 FD_SETSIZE 限制 */
+#define RECEPTOR_BENCH_IDLE_PAIRS           8
+#define RECEPTOR_BENCH_IDLE_MESSAGES        100000
+
+#ifdef _WIN32
+#define receptor_bench_close    closesocket
+#else
+#define receptor_bench_close    close
+#endif
+
+typedef struct {
+	const char             *name;
+	void                  (*init)(void);
+} receptor_bench_backend_t;
+
+/* 一端在循环中的连接，peer 为另一端；ping-pong 时两端都在循环中 */
+typedef struct receptor_bench_conn_s  receptor_bench_conn_t;
+
+struct receptor_bench_conn_s {
+	receptor_connection_t      *connection;
+	receptor_bench_conn_t      *peer;
+	receptor_socket_t           fd;
+	uint64_t                   *sent;       /* 一对连接共用的发送时刻 */
+};
+
+static receptor_bench_backend_t receptor_bench_backends[] = {
+#ifdef __linux__
+	{ "epoll", receptor_event_epoll_register },
+	{ "io_uring", receptor_event_uring_register },
+#endif
+#ifndef _WIN32
+	{ "poll", receptor_event_poll_register },
+#endif
+	{ "select", receptor_event_select_register },
+	{ NULL, NULL }
+};
+
+static receptor_histogram_t     receptor_bench_latency;
+static uint64_t                 receptor_bench_events;
+static uint64_t                 receptor_bench_target;
+static uint64_t                 receptor_bench_burst_start;
+static uint32_t                 receptor_bench_seed = 2463534242u;
+
+static uint32_t
+receptor_bench_random(void)
+{
+	receptor_bench_seed ^= receptor_bench_seed << 13;
+	receptor_bench_seed ^= receptor_bench_seed >> 17;
+	receptor_bench_seed ^= receptor_bench_seed << 5;
+
+	return receptor_bench_seed;
+}
+
+/* Windows 没有 socketpair，用回环 TCP 连接代替 */
+static receptor_int_t
+receptor_bench_socketpair(receptor_socket_t fds[2])
+{
+#ifdef _WIN32
+	SOCKET              ls;
+	int                 len;
+	struct sockaddr_in  sa;
+
+	ls = socket(AF_INET, SOCK_STREAM, 0);
+	if (ls == INVALID_SOCKET) {
+		return RECEPTOR_ERROR;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	len = sizeof(sa);
+
+	if (bind(ls, (struct sockaddr *)&sa, sizeof(sa)) != 0
+		|| listen(ls, 1) != 0
+		|| getsockname(ls, (struct sockaddr *)&sa, &len) != 0)
+	{
+		closesocket(ls);
+		return RECEPTOR_ERROR;
+	}
+
+	fds[0] = socket(AF_INET, SOCK_STREAM, 0);
+	if (fds[0] == INVALID_SOCKET || connect(fds[0], (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+		closesocket(ls);
+		return RECEPTOR_ERROR;
+	}
+
+	fds[1] = accept(ls, NULL, NULL);
+	closesocket(ls);
+
+	return (fds[1] == INVALID_SOCKET) ? RECEPTOR_ERROR : RECEPTOR_OK;
+#else
+	int sv[2];
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+		return RECEPTOR_ERROR;
+	}
+
+	fds[0] = sv[0];
+	fds[1] = sv[1];
+
+	return RECEPTOR_OK;
+#endif
+}
+
+static void
+receptor_bench_report(const char *backend, const char *scenario, uint64_t events, uint64_t elapsed)
+{
+	double rate;
+
+	rate = elapsed ? (double)events * 1e9 / (double)elapsed : 0.0;
+
+	printf("%-10s %-10s %12.0f %10.1f %10.1f %10.1f %10.1f\n", backend, scenario, rate,
+		receptor_histogram_percentile(&receptor_bench_latency, 50) / 1000.0,
+		receptor_histogram_percentile(&receptor_bench_latency, 99) / 1000.0,
+		receptor_histogram_percentile(&receptor_bench_latency, 99.9) / 1000.0,
+		receptor_bench_latency.max / 1000.0);
+}
+
+/* 取一个连接表中的连接并注册读事件 */
+static receptor_bench_conn_t *
+receptor_bench_conn_open(receptor_event_loop_t *loop, receptor_socket_t s, receptor_event_handler_pt handler)
+{
+	receptor_connection_t  *c;
+	receptor_bench_conn_t  *bc;
+
+	bc = calloc(1, sizeof(receptor_bench_conn_t));
+	if (bc == NULL) {
+		return NULL;
+	}
+
+	c = receptor_event_get_connection(loop, s);
+	if (c == NULL) {
+		free(bc);
+		return NULL;
+	}
+
+	c->data = bc;
+	c->read->handler = handler;
+	bc->connection = c;
+	bc->fd = s;
+
+	if (receptor_event_loop_add(loop, c->read, RECEPTOR_READ_EVENT, RECEPTOR_LEVEL_EVENT) != RECEPTOR_OK) {
+		receptor_event_free_connection(loop, c);
+		free(bc);
+		return NULL;
+	}
+
+	return bc;
+}
+
+static void
+receptor_bench_conn_close(receptor_event_loop_t *loop, receptor_bench_conn_t *bc)
+{
+	if (bc == NULL) {
+		return;
+	}
+
+	if (bc->connection) {
+		receptor_event_close_connection(loop, bc->connection);
+	}
+	else {
+		receptor_bench_close(bc->fd);
+	}
+
+	free(bc);
+}
+
+/* ==================== ping-pong ==================== */
+
+static void
+receptor_bench_pingpong_handler(receptor_event_t *ev)
+{
+	char                    buf[16];
+	uint64_t                now;
+	receptor_connection_t  *c = ev->data;
+	receptor_bench_conn_t  *bc = c->data;
+
+	if (recv(c->fd, buf, sizeof(buf), 0) <= 0) {
+		return;
+	}
+
+	now = receptor_event_time_ns();
+	receptor_histogram_record(&receptor_bench_latency, now - *bc->sent);
+
+	if (++receptor_bench_events >= receptor_bench_target) {
+		return;
+	}
+
+	*bc->sent = now;
+	(void)send(c->fd, "x", 1, 0);
+}
+
+static void
+receptor_bench_fanin_idle_handler(receptor_event_t *ev)
+{
+	char                    buf[16];
+	receptor_connection_t  *c = ev->data;
+
+	(void)recv(c->fd, buf, sizeof(buf), 0);
+}
+
+/*
+ * pairs 对连接两端都在循环中，各自收到一个字节后回写一个字节；
+ * idle 个只注册不活动的连接用于测量描述符数量带来的开销。
+ */
+static receptor_int_t
+receptor_bench_pingpong(const char *backend, const char *scenario,
+	receptor_uint_t pairs, receptor_uint_t idle, uint64_t messages)
+{
+	receptor_uint_t         i, n;
+	receptor_int_t          rc;
+	uint64_t                start, *sent;
+	receptor_socket_t       fds[2];
+	receptor_event_loop_t  *loop;
+	receptor_bench_conn_t **conns;
+
+	loop = receptor_event_loop_create();
+	if (loop == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	n = 2 * pairs + idle;
+	rc = RECEPTOR_ERROR;
+
+	conns = calloc(n, sizeof(receptor_bench_conn_t *));
+	sent = calloc(pairs, sizeof(uint64_t));
+
+	if (conns == NULL || sent == NULL
+		|| receptor_event_loop_init_connections(loop, n) != RECEPTOR_OK)
+	{
+		goto done;
+	}
+
+	for (i = 0; i < pairs; i++) {
+		if (receptor_bench_socketpair(fds) != RECEPTOR_OK) {
+			goto done;
+		}
+
+		conns[2 * i] = receptor_bench_conn_open(loop, fds[0], receptor_bench_pingpong_handler);
+		conns[2 * i + 1] = receptor_bench_conn_open(loop, fds[1], receptor_bench_pingpong_handler);
+
+		if (conns[2 * i] == NULL || conns[2 * i + 1] == NULL) {
+			goto done;
+		}
+
+		conns[2 * i]->sent = &sent[i];
+		conns[2 * i + 1]->sent = &sent[i];
+	}
+
+	for (i = 0; i < idle; i++) {
+		if (receptor_bench_socketpair(fds) != RECEPTOR_OK) {
+			goto done;
+		}
+
+		/* 另一端留在循环外，不写入，只占用一个描述符 */
+		conns[2 * pairs + i] = receptor_bench_conn_open(loop, fds[0], receptor_bench_fanin_idle_handler);
+		if (conns[2 * pairs + i] == NULL) {
+			receptor_bench_close(fds[0]);
+			receptor_bench_close(fds[1]);
+			goto done;
+		}
+
+		conns[2 * pairs + i]->peer = calloc(1, sizeof(receptor_bench_conn_t));
+		if (conns[2 * pairs + i]->peer == NULL) {
+			receptor_bench_close(fds[1]);
+			goto done;
+		}
+
+		conns[2 * pairs + i]->peer->fd = fds[1];
+	}
+
+	receptor_histogram_reset(&receptor_bench_latency);
+	receptor_bench_events = 0;
+	receptor_bench_target = messages;
+
+	start = receptor_event_time_ns();
+
+	for (i = 0; i < pairs; i++) {
+		sent[i] = receptor_event_time_ns();
+		(void)send(conns[2 * i]->fd, "x", 1, 0);
+	}
+
+	while (receptor_bench_events < receptor_bench_target) {
+		if (receptor_event_loop_process_timeout(loop, 1000) != RECEPTOR_OK) {
+			goto done;
+		}
+	}
+
+	receptor_bench_report(backend, scenario, receptor_bench_events, receptor_event_time_ns() - start);
+	rc = RECEPTOR_OK;
+
+done:
+
+	for (i = 0; conns && i < n; i++) {
+		if (conns[i] && conns[i]->peer) {
+			receptor_bench_close(conns[i]->peer->fd);
+			free(conns[i]->peer);
+		}
+
+		receptor_bench_conn_close(loop, conns[i]);
+	}
+
+	free(conns);
+	free(sent);
+	receptor_event_loop_destroy(loop);
+
+	return rc;
+}
+
+/* ==================== 突发扇入 ==================== */
+
+static void
+receptor_bench_fanin_handler(receptor_event_t *ev)
+{
+	char                    buf[16];
+	receptor_connection_t  *c = ev->data;
+
+	if (recv(c->fd, buf, sizeof(buf), 0) <= 0) {
+		return;
+	}
+
+	receptor_histogram_record(&receptor_bench_latency, receptor_event_time_ns() - receptor_bench_burst_start);
+	receptor_bench_events++;
+}
+
+/* 每轮向所有连接各写一个字节，记录从写入开始到每个连接被处理的延迟 */
+static receptor_int_t
+receptor_bench_fanin(const char *backend)
+{
+	receptor_uint_t         i, round;
+	receptor_int_t          rc;
+	uint64_t                start, total;
+	receptor_socket_t       fds[2];
+	receptor_socket_t      *peers;
+	receptor_event_loop_t  *loop;
+	receptor_bench_conn_t **conns;
+
+	loop = receptor_event_loop_create();
+	if (loop == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	rc = RECEPTOR_ERROR;
+
+	conns = calloc(RECEPTOR_BENCH_FANIN_CONNS, sizeof(receptor_bench_conn_t *));
+	peers = malloc(RECEPTOR_BENCH_FANIN_CONNS * sizeof(receptor_socket_t));
+
+	if (conns == NULL || peers == NULL
+		|| receptor_event_loop_init_connections(loop, RECEPTOR_BENCH_FANIN_CONNS) != RECEPTOR_OK)
+	{
+		goto done;
+	}
+
+	for (i = 0; i < RECEPTOR_BENCH_FANIN_CONNS; i++) {
+		peers[i] = RECEPTOR_INVALID_SOCKET;
+	}
+
+	for (i = 0; i < RECEPTOR_BENCH_FANIN_CONNS; i++) {
+		if (receptor_bench_socketpair(fds) != RECEPTOR_OK) {
+			goto done;
+		}
+
+		peers[i] = fds[1];
+
+		conns[i] = receptor_bench_conn_open(loop, fds[0], receptor_bench_fanin_handler);
+		if (conns[i] == NULL) {
+			receptor_bench_close(fds[0]);
+			goto done;
+		}
+	}
+
+	receptor_histogram_reset(&receptor_bench_latency);
+	receptor_bench_events = 0;
+	total = 0;
+
+	start = receptor_event_time_ns();
+
+	for (round = 0; round < RECEPTOR_BENCH_FANIN_ROUNDS; round++) {
+		receptor_bench_burst_start = receptor_event_time_ns();
+
+		for (i = 0; i < RECEPTOR_BENCH_FANIN_CONNS; i++) {
+			(void)send(peers[i], "x", 1, 0);
+		}
+
+		total += RECEPTOR_BENCH_FANIN_CONNS;
+
+		while (receptor_bench_events < total) {
+			if (receptor_event_loop_process_timeout(loop, 1000) != RECEPTOR_OK) {
+				goto done;
+			}
+		}
+	}
+
+	receptor_bench_report(backend, "fanin", receptor_bench_events, receptor_event_time_ns() - start);
+	rc = RECEPTOR_OK;
+
+done:
+
+	for (i = 0; conns && i < RECEPTOR_BENCH_FANIN_CONNS; i++) {
+		receptor_bench_conn_close(loop, conns[i]);
+
+		if (peers && peers[i] != RECEPTOR_INVALID_SOCKET) {
+			receptor_bench_close(peers[i]);
+		}
+	}
+
+	free(conns);
+	free(peers);
+	receptor_event_loop_destroy(loop);
+
+	return rc;
+}
+
+/* ==================== 定时器 ==================== */
+
+static receptor_event_loop_t   *receptor_bench_timer_loop;
+
+static void
+receptor_bench_timer_handler(receptor_event_t *ev)
+{
+	receptor_msec_t     late;
+	receptor_event_loop_t *loop = receptor_bench_timer_loop;
+
+	late = loop->current_msec - ev->timer_expires;
+	receptor_histogram_record(&receptor_bench_latency, (uint64_t)(late > 0 ? late : 0) * 1000000);
+	receptor_bench_events++;
+
+	receptor_event_add_timer(loop, ev, 1 + receptor_bench_random() % 16);
+}
+
+/*
+ * 到期的定时器随机重新添加 1 到 16 毫秒，每轮循环再随机重设一批，
+ * 模拟长连接上频繁刷新的超时。延迟为到期后被处理的滞后，精度为毫秒。
+ */
+static receptor_int_t
+receptor_bench_timers(const char *backend)
+{
+	receptor_uint_t         i;
+	uint64_t                start, resets;
+	receptor_msec_t         deadline;
+	receptor_event_t       *evs, *ev;
+	receptor_event_loop_t  *loop;
+
+	loop = receptor_event_loop_create();
+	if (loop == NULL) {
+		return RECEPTOR_ERROR;
+	}
+
+	evs = calloc(RECEPTOR_BENCH_TIMERS, sizeof(receptor_event_t));
+	if (evs == NULL) {
+		receptor_event_loop_destroy(loop);
+		return RECEPTOR_ERROR;
+	}
+
+	receptor_bench_timer_loop = loop;
+	receptor_histogram_reset(&receptor_bench_latency);
+	receptor_bench_events = 0;
+	resets = 0;
+
+	for (i = 0; i < RECEPTOR_BENCH_TIMERS; i++) {
+		evs[i].handler = receptor_bench_timer_handler;
+		receptor_event_add_timer(loop, &evs[i], 1 + receptor_bench_random() % 256);
+	}
+
+	start = receptor_event_time_ns();
+	deadline = loop->current_msec + RECEPTOR_BENCH_TIMER_DURATION;
+
+	while (loop->current_msec < deadline) {
+		if (receptor_event_loop_process_timeout(loop, RECEPTOR_TIMER_INFINITE) != RECEPTOR_OK) {
+			break;
+		}
+
+		for (i = 0; i < RECEPTOR_BENCH_TIMER_CHURN; i++) {
+			ev = &evs[receptor_bench_random() % RECEPTOR_BENCH_TIMERS];
+			receptor_event_add_timer(loop, ev, 1 + receptor_bench_random() % 1024);
+		}
+
+		resets += RECEPTOR_BENCH_TIMER_CHURN;
+	}
+
+	receptor_bench_report(backend, "timers", receptor_bench_events + resets, receptor_event_time_ns() - start);
+
+	for (i = 0; i < RECEPTOR_BENCH_TIMERS; i++) {
+		receptor_event_del_timer(loop, &evs[i]);
+	}
+
+	free(evs);
+	receptor_event_loop_destroy(loop);
+
+	return RECEPTOR_OK;
+}
+
+/* ==================== 入口 ==================== */
+
+static receptor_int_t
+receptor_bench_selected(int argc, char **argv, const char *name)
+{
+	int i;
+
+	if (argc < 2) {
+		return 1;
+	}
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], name) == 0) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	int                         failed;
+	receptor_bench_backend_t   *b;
+#ifdef _WIN32
+	WSADATA                     wsa;
+
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+		return 1;
+	}
+#endif
+
+	failed = 0;
+
+	printf("%-10s %-10s %12s %10s %10s %10s %10s\n", "backend", "scenario", "events/s",
+		"p50(us)", "p99(us)", "p99.9(us)", "max(us)");
+
+	for (b = receptor_bench_backends; b->name; b++) {
+		if (!receptor_bench_selected(argc, argv, b->name)) {
+			continue;
+		}
+
+		b->init();
+
+		if (receptor_bench_pingpong(b->name, "pingpong", RECEPTOR_BENCH_PINGPONG_PAIRS, 0,
+				RECEPTOR_BENCH_PINGPONG_MESSAGES) != RECEPTOR_OK
+			|| receptor_bench_fanin(b->name) != RECEPTOR_OK
+			|| receptor_bench_timers(b->name) != RECEPTOR_OK
+			|| receptor_bench_pingpong(b->name, "idle", RECEPTOR_BENCH_IDLE_PAIRS, RECEPTOR_BENCH_IDLE_CONNS,
+				RECEPTOR_BENCH_IDLE_MESSAGES) != RECEPTOR_OK)
+		{
+			fprintf(stderr, "%s: benchmark failed\n", b->name);
+			failed = 1;
+		}
+	}
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+
+	return failed;
+}
@@ -0,0 +1,357 @@
+#include <receptor/def.h>
+#include <receptor_event.h>
+#include <receptor_event_connection.h>
+#include <receptor_event_listen.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* ==================== io_uring 后端测试 ==================== */
+
+/*
+ * 以边沿触发注册的连接只带 RECEPTOR_CLOSE_EVENT 关闭时，POLL_REMOVE
+ * 必须按注册时的 user_data 撤销 multishot poll：撤销失败时内核仍持有
+ * 文件引用，close() 之后对端收不到 EOF。
+ *
+ * 监听套接字走 multishot accept，RECEPTOR_RECV_EVENT 的连接走 multishot
+ * recv：收到的字节数须与发送的一致，读到 EOF；带着未读缓冲区关闭的连接
+ * 须把缓冲区交还，连接数超过缓冲区个数时后面的连接仍能收到数据。
+ * 内核不支持 io_uring 时后端退回 epoll，测试照常通过。
+ */
+
+#define RECEPTOR_TEST_ROUNDS    16
+#define RECEPTOR_TEST_CLIENTS   300     /* 多于后端的缓冲区个数 */
+#define RECEPTOR_TEST_CHUNK     1000
+
+static receptor_uint_t          receptor_test_reads;
+static receptor_event_loop_t   *receptor_test_loop;
+static receptor_uint_t          receptor_test_accepted;
+static receptor_uint_t          receptor_test_closed;
+static size_t                   receptor_test_bytes;
+static receptor_uint_t          receptor_test_hold;     /* 置位时读事件不取数据 */
+static receptor_connection_t   *receptor_test_conns[RECEPTOR_TEST_CLIENTS];
+
+static void
+receptor_test_read_handler(receptor_event_t *ev)
+{
+	char                    buf[16];
+	receptor_connection_t  *c = ev->data;
+
+	while (read(c->fd, buf, sizeof(buf)) > 0) {
+		receptor_test_reads++;
+	}
+}
+
+static int
+receptor_test_nonblocking(int fd)
+{
+	int flags;
+
+	flags = fcntl(fd, F_GETFL);
+	return (flags == -1) ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static int
+receptor_test_close_clear(receptor_event_loop_t *loop)
+{
+	int                     sv[2];
+	char                    buf[16];
+	ssize_t                 n;
+	receptor_uint_t         i;
+	receptor_connection_t  *c;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1
+		|| receptor_test_nonblocking(sv[0]) == -1
+		|| receptor_test_nonblocking(sv[1]) == -1)
+	{
+		perror("socketpair");
+		return -1;
+	}
+
+	c = receptor_event_get_connection(loop, sv[0]);
+	if (c == NULL) {
+		fprintf(stderr, "no free connection\n");
+		return -1;
+	}
+
+	c->read->handler = receptor_test_read_handler;
+
+	if (receptor_event_loop_add(loop, c->read, RECEPTOR_READ_EVENT, RECEPTOR_CLEAR_EVENT) != RECEPTOR_OK) {
+		fprintf(stderr, "add failed\n");
+		return -1;
+	}
+
+	/* 确认 poll 已提交并产生过完成 */
+	receptor_test_reads = 0;
+
+	for (i = 0; i < RECEPTOR_TEST_ROUNDS && receptor_test_reads == 0; i++) {
+		(void)write(sv[1], "x", 1);
+		(void)receptor_event_loop_process_timeout(loop, 100);
+	}
+
+	if (receptor_test_reads == 0) {
+		fprintf(stderr, "read event never fired\n");
+		return -1;
+	}
+
+	receptor_event_close_connection(loop, c);
+
+	/* 提交 POLL_REMOVE 并取回它的完成 */
+	(void)receptor_event_loop_process_timeout(loop, 10);
+	(void)receptor_event_loop_process_timeout(loop, 10);
+
+	n = read(sv[1], buf, sizeof(buf));
+	close(sv[1]);
+
+	if (n != 0) {
+		fprintf(stderr, "peer did not see EOF after close (read returned %d, errno %d)\n",
+			(int)n, (n == -1) ? errno : 0);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+receptor_test_recv_handler(receptor_event_t *ev)
+{
+	char                    buf[1500];
+	receptor_int_t          n;
+	receptor_connection_t  *c = ev->data;
+
+	if (receptor_test_hold) {
+		return;
+	}
+
+	for ( ;; ) {
+		n = receptor_event_recv(receptor_test_loop, c, buf, sizeof(buf));
+
+		if (n > 0) {
+			receptor_test_bytes += (size_t)n;
+			continue;
+		}
+
+		if (n == 0) {
+			receptor_test_closed++;
+			receptor_event_close_connection(receptor_test_loop, c);
+		}
+
+		return;
+	}
+}
+
+static void
+receptor_test_accept_handler(receptor_listening_t *ls, receptor_socket_t s)
+{
+	receptor_connection_t *c;
+
+	c = receptor_event_get_connection(ls->loop, s);
+	if (c == NULL) {
+		close(s);
+		return;
+	}
+
+	c->read->handler = receptor_test_recv_handler;
+
+	if (receptor_event_loop_add(ls->loop, c->read, RECEPTOR_READ_EVENT,
+		RECEPTOR_CLEAR_EVENT | RECEPTOR_RECV_EVENT) != RECEPTOR_OK)
+	{
+		receptor_event_close_connection(ls->loop, c);
+		return;
+	}
+
+	if (receptor_test_accepted < RECEPTOR_TEST_CLIENTS) {
+		receptor_test_conns[receptor_test_accepted] = c;
+	}
+
+	receptor_test_accepted++;
+}
+
+static int
+receptor_test_connect(const struct sockaddr_in *sin)
+{
+	int fd;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd == -1) {
+		return -1;
+	}
+
+	if (connect(fd, (const struct sockaddr *)sin, sizeof(struct sockaddr_in)) == -1) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static int
+receptor_test_recv_buffers(receptor_event_loop_t *loop)
+{
+	int                     fds[RECEPTOR_TEST_CLIENTS];
+	char                    chunk[RECEPTOR_TEST_CHUNK];
+	size_t                  sent;
+	socklen_t               len;
+	receptor_uint_t         i, n;
+	struct sockaddr_in      sin;
+	receptor_listening_t   *ls;
+
+	receptor_test_loop = loop;
+	memset(chunk, 'x', sizeof(chunk));
+
+	memset(&sin, 0, sizeof(struct sockaddr_in));
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	ls = receptor_event_listening_create(loop, (struct sockaddr *)&sin, sizeof(struct sockaddr_in),
+		receptor_test_accept_handler);
+	if (ls == NULL || receptor_event_listening_open(ls) != RECEPTOR_OK) {
+		fprintf(stderr, "listen failed\n");
+		return -1;
+	}
+
+	len = sizeof(struct sockaddr_in);
+	if (getsockname(ls->fd, (struct sockaddr *)&sin, &len) == -1) {
+		perror("getsockname");
+		return -1;
+	}
+
+	/* 一个连接连续收取，缓冲区交还后反复使用 */
+	fds[0] = receptor_test_connect(&sin);
+	if (fds[0] == -1) {
+		perror("connect");
+		return -1;
+	}
+
+	sent = 0;
+
+	for (i = 0; i < 4 * RECEPTOR_TEST_CLIENTS; i++) {
+		if (write(fds[0], chunk, sizeof(chunk)) == (ssize_t)sizeof(chunk)) {
+			sent += sizeof(chunk);
+		}
+
+		(void)receptor_event_loop_process_timeout(loop, 0);
+	}
+
+	close(fds[0]);
+
+	for (i = 0; i < RECEPTOR_TEST_ROUNDS && receptor_test_closed == 0; i++) {
+		(void)receptor_event_loop_process_timeout(loop, 100);
+	}
+
+	if (receptor_test_accepted != 1 || receptor_test_closed != 1 || receptor_test_bytes != sent) {
+		fprintf(stderr, "single connection: accepted %lu closed %lu received %lu of %lu bytes\n",
+			(unsigned long)receptor_test_accepted, (unsigned long)receptor_test_closed,
+			(unsigned long)receptor_test_bytes, (unsigned long)sent);
+		return -1;
+	}
+
+	/* 每个连接收到数据后不读就关闭，缓冲区须交还，否则后面的连接收不到 */
+	receptor_test_accepted = 0;
+	receptor_test_hold = 1;
+
+	for (n = 0; n < RECEPTOR_TEST_CLIENTS; n++) {
+		fds[n] = receptor_test_connect(&sin);
+		if (fds[n] == -1) {
+			perror("connect");
+			return -1;
+		}
+
+		for (i = 0; i < RECEPTOR_TEST_ROUNDS && receptor_test_accepted <= n; i++) {
+			(void)receptor_event_loop_process_timeout(loop, 10);
+		}
+
+		if (receptor_test_accepted <= n) {
+			fprintf(stderr, "connection %lu not accepted\n", (unsigned long)n);
+			return -1;
+		}
+
+		(void)write(fds[n], chunk, sizeof(chunk));
+		(void)receptor_event_loop_process_timeout(loop, 10);
+		(void)receptor_event_loop_process_timeout(loop, 10);
+
+		receptor_event_close_connection(loop, receptor_test_conns[n]);
+		close(fds[n]);
+	}
+
+	/* 取回撤销请求的完成 */
+	(void)receptor_event_loop_process_timeout(loop, 10);
+	(void)receptor_event_loop_process_timeout(loop, 10);
+
+	/* 缓冲区都已交还时，新连接照常收到数据 */
+	receptor_test_accepted = 0;
+	receptor_test_closed = 0;
+	receptor_test_bytes = 0;
+	receptor_test_hold = 0;
+
+	fds[0] = receptor_test_connect(&sin);
+	if (fds[0] == -1) {
+		perror("connect");
+		return -1;
+	}
+
+	(void)write(fds[0], chunk, sizeof(chunk));
+	close(fds[0]);
+
+	for (i = 0; i < RECEPTOR_TEST_ROUNDS && receptor_test_closed == 0; i++) {
+		(void)receptor_event_loop_process_timeout(loop, 100);
+	}
+
+	if (receptor_test_closed != 1 || receptor_test_bytes != sizeof(chunk)) {
+		fprintf(stderr, "after closing with unread buffers: received %lu of %lu bytes\n",
+			(unsigned long)receptor_test_bytes, (unsigned long)sizeof(chunk));
+		return -1;
+	}
+
+	receptor_event_listening_close(ls);
+
+	return 0;
+}
+
+int
+main(void)
+{
+	int                             rc;
+	receptor_event_loop_t          *loop;
+	receptor_event_loop_stats_t     stats;
+
+	receptor_event_uring_register();
+
+	loop = receptor_event_loop_create();
+	if (loop == NULL || receptor_event_loop_init_connections(loop, 8) != RECEPTOR_OK) {
+		fprintf(stderr, "failed to create loop\n");
+		return 1;
+	}
+
+	rc = receptor_test_close_clear(loop);
+
+	printf("close with RECEPTOR_CLOSE_EVENT: %s\n", rc == 0 ? "ok" : "FAILED");
+
+	if (receptor_test_recv_buffers(loop) != 0) {
+		rc = -1;
+	}
+
+	printf("multishot accept and buffered recv: %s\n", rc == 0 ? "ok" : "FAILED");
+
+	receptor_event_loop_get_stats(loop, &stats);
+
+	if (stats.cancel_failed != 0) {
+		fprintf(stderr, "cancel failed %lu times\n", (unsigned long)stats.cancel_failed);
+		rc = -1;
+	}
+
+	/* 缓冲区未交还时后面的连接会耗尽缓冲区，数据改由 recv() 取到，只能从这里看出 */
+	if (stats.recv_nobufs != 0) {
+		fprintf(stderr, "provided buffers ran out %lu times\n", (unsigned long)stats.recv_nobufs);
+		rc = -1;
+	}
+
+	receptor_event_loop_destroy(loop);
+
+	return rc == 0 ? 0 : 1;
+}